@@ -0,0 +1,258 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+// Sends video from one sender to a number of receivers in the same process
+// and reports throughput, latency and cost as JSON on stdout. For example:
+//
+//   npm run bench -- --xres=3840 --yres=2160 --fps=60 --receivers=4
+//
+// Options, as --name=value:
+//   xres, yres        frame size (1920x1080)
+//   fourcc            UYVY, BGRA, BGRX, RGBA, RGBX, UYVA, P216, PA16, I420,
+//                     YV12 or NV12 (UYVY)
+//   fps               frames per second, as a number or N/D (30000/1001)
+//   receivers         number of receivers (1)
+//   duration          seconds to measure for (10)
+//   warmup            seconds to run before measuring (2)
+//   send              video, videoAsync (video)
+//   zeroCopy          receivers wrap NDI frames rather than copying (false)
+//   binaryHeader      receivers decode frame headers lazily (true)
+//   name              sender name (grandiose-bench-<pid>)
+//   out               also write the JSON to this file
+//
+// Run with GRANDIOSE_MOCK=1 to measure against the mock NDI library.
+
+const fs = require('fs')
+const grandiose = require('../index.js')
+
+const FOURCCS = {
+  UYVY: [grandiose.FOURCC_UYVY, 2], UYVA: [grandiose.FOURCC_UYVA, 2],
+  P216: [grandiose.FOURCC_P216, 2], PA16: [grandiose.FOURCC_PA16, 2],
+  YV12: [grandiose.FOURCC_YV12, 1], I420: [grandiose.FOURCC_I420, 1],
+  NV12: [grandiose.FOURCC_NV12, 1],
+  BGRA: [grandiose.FOURCC_BGRA, 4], BGRX: [grandiose.FOURCC_BGRX, 4],
+  RGBA: [grandiose.FOURCC_RGBA, 4], RGBX: [grandiose.FOURCC_RGBX, 4],
+}
+
+function parseOptions(argv) {
+  const options = {
+    xres: 1920, yres: 1080, fourcc: 'UYVY', fps: '30000/1001',
+    receivers: 1, duration: 10, warmup: 2, send: 'video',
+    zeroCopy: false, binaryHeader: true,
+    name: `grandiose-bench-${process.pid}`, out: undefined,
+  }
+  for (const arg of argv) {
+    const match = /^--([^=]+)(?:=(.*))?$/.exec(arg)
+    if (!match || !(match[1] in options)) throw new Error(`Unknown option ${arg}`)
+    const [, key, value] = match
+    const current = options[key]
+    if (typeof current === 'number') options[key] = Number(value)
+    else if (typeof current === 'boolean') options[key] = value === undefined || value === 'true'
+    else options[key] = value
+  }
+
+  if (!FOURCCS[options.fourcc]) throw new Error(`Unknown FourCC ${options.fourcc}`)
+  const [n, d] = String(options.fps).split('/').map(Number)
+  options.frameRateN = d ? n : Math.round(n * 1000)
+  options.frameRateD = d ? d : 1000
+  return options
+}
+
+// Nanoseconds since the benchmark started, carried in each frame's timecode
+const epoch = process.hrtime.bigint()
+const now = () => process.hrtime.bigint() - epoch
+
+function percentiles(values) {
+  if (values.length === 0) return null
+  const sorted = Float64Array.from(values).sort()
+  const at = (p) => sorted[Math.min(sorted.length - 1, Math.floor(p * sorted.length))]
+  let sum = 0
+  for (const v of sorted) sum += v
+  return {
+    count: sorted.length,
+    mean: sum / sorted.length,
+    min: sorted[0],
+    p50: at(0.5), p90: at(0.9), p99: at(0.99), p999: at(0.999),
+    max: sorted[sorted.length - 1],
+  }
+}
+
+async function findSource(name, timeout) {
+  const finder = new grandiose.GrandioseFinder({ showLocalSources: true })
+  const wanted = (sources) => sources.find((s) => s.name.endsWith(`(${name})`))
+  try {
+    return await new Promise((resolve, reject) => {
+      const found = wanted(finder.getCurrentSources())
+      if (found) return resolve(found)
+      const timer = setTimeout(() => reject(new Error(`Sender ${name} was not found`)), timeout)
+      finder.on('added', (added) => {
+        const source = wanted(added)
+        if (source) {
+          clearTimeout(timer)
+          resolve(source)
+        }
+      })
+    })
+  } finally {
+    finder.dispose()
+  }
+}
+
+async function sendLoop(sender, options, state) {
+  const [fourCC, bytesPerPixel] = FOURCCS[options.fourcc]
+  const format = {
+    xres: options.xres, yres: options.yres, fourCC,
+    lineStrideBytes: options.xres * bytesPerPixel,
+  }
+  const frame = {
+    ...format,
+    frameRateN: options.frameRateN, frameRateD: options.frameRateD,
+    pictureAspectRatio: options.xres / options.yres,
+    frameFormatType: grandiose.FORMAT_TYPE_PROGRESSIVE,
+  }
+
+  while (state.sending) {
+    const data = sender.allocFrame(format)
+    const sent = { ...frame, data, timecode: now() / 100n }
+    if (options.send === 'videoAsync') {
+      sender.videoAsync(sent)
+      // Let the receivers' completions run between frames
+      await new Promise(setImmediate)
+    } else {
+      await sender.video(sent)
+    }
+    if (state.measuring) state.sent++
+  }
+  if (options.send === 'videoAsync') sender.flushVideo()
+}
+
+async function receiveLoop(receiver, state, result) {
+  while (state.receiving) {
+    let frame
+    try {
+      frame = await receiver.video(1000)
+    } catch (err) {
+      result.timeouts++
+      continue
+    }
+    if (!state.measuring) continue
+    const sentAt = frame.rawTimecode !== undefined ? frame.rawTimecode :
+      BigInt(frame.timecode[0]) * 10000000n + BigInt(Math.floor(frame.timecode[1] / 100))
+    result.latencies.push(Number(now() / 100n - sentAt) / 10000) // ms
+    result.frames++
+  }
+}
+
+// Carriers allocated by the process so far, from grandiose.metrics()
+function carriersAllocated() {
+  const match = /^grandiose_carriers_allocated_total (\d+)$/m.exec(grandiose.metrics())
+  return match ? Number(match[1]) : 0
+}
+
+function receiverStats(receiver) {
+  const { grandiose: g, dropped } = receiver.stats()
+  return { completions: g.completions, completionTime: g.completionTime, bytesCopied: g.bytesCopied, dropped: dropped.video }
+}
+
+async function run() {
+  const options = parseOptions(process.argv.slice(2))
+  const sender = await grandiose.send({ name: options.name, clockVideo: true, clockAudio: false })
+  const source = await findSource(options.name, 10000)
+
+  const receivers = []
+  for (let i = 0; i < options.receivers; i++) {
+    receivers.push(await grandiose.receive({
+      source,
+      colorFormat: grandiose.COLOR_FORMAT_FASTEST,
+      zeroCopy: options.zeroCopy,
+      binaryHeader: options.binaryHeader,
+      name: `${options.name}-receiver-${i}`,
+    }))
+  }
+
+  const state = { sending: true, receiving: true, measuring: false, sent: 0 }
+  const results = receivers.map(() => ({ frames: 0, timeouts: 0, latencies: [] }))
+  const receiving = receivers.map((r, i) => receiveLoop(r, state, results[i]))
+  const sending = sendLoop(sender, options, state)
+
+  console.error(`Warming up for ${options.warmup}s`)
+  await new Promise((resolve) => setTimeout(resolve, options.warmup * 1000))
+
+  const before = receivers.map(receiverStats)
+  const carriersBefore = carriersAllocated()
+  const cpuBefore = process.cpuUsage()
+  const start = now()
+  state.measuring = true
+  console.error(`Measuring for ${options.duration}s`)
+  await new Promise((resolve) => setTimeout(resolve, options.duration * 1000))
+  state.measuring = false
+  const elapsed = Number(now() - start) / 1e9
+  const cpu = process.cpuUsage(cpuBefore)
+  const after = receivers.map(receiverStats)
+  const carriers = carriersAllocated() - carriersBefore
+
+  state.sending = false
+  await sending
+  state.receiving = false
+  await Promise.all(receiving)
+
+  const perReceiver = results.map((result, i) => ({
+    fps: result.frames / elapsed,
+    frames: result.frames,
+    timeouts: result.timeouts,
+    dropped: after[i].dropped - before[i].dropped,
+    latencyMs: percentiles(result.latencies),
+    completeCallbackUs: {
+      total: after[i].completionTime - before[i].completionTime,
+      perFrame: (after[i].completionTime - before[i].completionTime) /
+        Math.max(1, after[i].completions - before[i].completions),
+    },
+    copyBytesPerSecond: (after[i].bytesCopied - before[i].bytesCopied) / elapsed,
+  }))
+
+  const report = {
+    options: { ...options, out: undefined },
+    version: grandiose.version(),
+    mock: process.env.GRANDIOSE_MOCK === '1',
+    durationSeconds: elapsed,
+    sent: { frames: state.sent, fps: state.sent / elapsed },
+    received: {
+      fps: perReceiver.reduce((sum, r) => sum + r.fps, 0) / perReceiver.length,
+      latencyMs: percentiles(results.flatMap((r) => r.latencies)),
+      completeCallbackUs: perReceiver.reduce((sum, r) => sum + r.completeCallbackUs.total, 0),
+      copyBytesPerSecond: perReceiver.reduce((sum, r) => sum + r.copyBytesPerSecond, 0),
+    },
+    receivers: perReceiver,
+    cpu: {
+      userMs: cpu.user / 1000,
+      systemMs: cpu.system / 1000,
+      percent: (cpu.user + cpu.system) / 1e6 / elapsed * 100,
+    },
+    framePool: sender.framePoolStats(),
+    // Should be 0 once warmed up, as carriers are reused between frames
+    carriersAllocated: carriers,
+    executor: grandiose.executorStats(),
+  }
+
+  await sender.destroy()
+  const json = JSON.stringify(report, null, 2)
+  console.log(json)
+  if (options.out) fs.writeFileSync(options.out, json + '\n')
+}
+
+run().then(() => process.exit(0), (err) => {
+  console.error(err)
+  process.exit(1)
+})
@@ -0,0 +1,107 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+// Runs the native microbenchmarks in bench/native_bench.cc across a range of
+// frame sizes and channel counts, printing JSON with ns/frame and bytes/s for
+// each. Build them first with npm run build:bench. Options, as --name=value:
+//   iterations   scale factor for the number of iterations of each case (1)
+//   out          also write the JSON to this file
+
+const fs = require('fs')
+const path = require('path')
+const bench = require('../build/Release/grandiose_bench.node')
+
+const RESOLUTIONS = [[1280, 720], [1920, 1080], [3840, 2160]]
+const CHANNELS = [2, 8, 16]
+const SAMPLES = 1602 // 48kHz at 29.97fps
+const AUDIO_FORMATS = { float32Separate: 0, float32Interleaved: 1, int16Interleaved: 2 }
+
+// The real NDI(tm) library, used for the interleaving utilities if present
+const NDI_LIBRARY = {
+  linux: 'lib/linux_x64/libndi.so.5',
+  darwin: 'lib/mac_universal/libndi.dylib',
+}[process.platform]
+
+// Stand-ins for the classes index.js registers for binary header frames
+class BenchFrame {
+  constructor(header, data, metadata) {
+    this.header = header
+    this.data = data
+    this.metadata = metadata
+  }
+}
+bench.setFrameClasses(BenchFrame, BenchFrame)
+
+function parseOptions(argv) {
+  const options = { iterations: 1, out: undefined }
+  for (const arg of argv) {
+    const match = /^--([^=]+)=(.*)$/.exec(arg)
+    if (!match || !(match[1] in options)) throw new Error(`Unknown option ${arg}`)
+    options[match[1]] = match[1] === 'iterations' ? Number(match[2]) : match[2]
+  }
+  return options
+}
+
+function run() {
+  const options = parseOptions(process.argv.slice(2))
+  const scale = (n) => Math.max(1, Math.round(n * options.iterations))
+  const results = []
+
+  for (const [xres, yres] of RESOLUTIONS) {
+    const iterations = scale(xres > 1920 ? 50 : 200)
+    for (const zeroCopy of [false, true]) {
+      for (const binaryHeader of [false, true]) {
+        results.push({
+          xres, yres, zeroCopy, binaryHeader,
+          ...bench.videoComplete({ xres, yres, iterations, zeroCopy, binaryHeader }),
+        })
+      }
+    }
+
+    const frame = {
+      xres, yres, frameRateN: 30000, frameRateD: 1001,
+      pictureAspectRatio: xres / yres, frameFormatType: 1,
+      fourCC: 0x59565955, lineStrideBytes: xres * 2,
+      data: Buffer.alloc(xres * 2 * yres),
+    }
+    results.push({ xres, yres, ...bench.videoSendParse(frame, scale(10000)) })
+  }
+
+  for (const channels of CHANNELS) {
+    const iterations = scale(2000)
+    for (const [format, audioFormat] of Object.entries(AUDIO_FORMATS)) {
+      for (const binaryHeader of [false, true]) {
+        const { convert, complete } = bench.audioComplete({
+          channels, samples: SAMPLES, audioFormat, iterations, binaryHeader,
+        })
+        const params = { channels, samples: SAMPLES, audioFormat: format, binaryHeader }
+        results.push({ ...params, ...convert }, { ...params, ...complete })
+      }
+    }
+
+    const library = NDI_LIBRARY && path.join(__dirname, '..', NDI_LIBRARY)
+    const { implementation, interleaved16s, interleaved32f } = bench.interleave({
+      channels, samples: SAMPLES, iterations, library,
+    })
+    const params = { channels, samples: SAMPLES, implementation }
+    results.push({ ...params, ...interleaved16s }, { ...params, ...interleaved32f })
+  }
+
+  const json = JSON.stringify({ node: process.version, results }, null, 2)
+  console.log(json)
+  if (options.out) fs.writeFileSync(options.out, json + '\n')
+}
+
+run()
@@ -0,0 +1,359 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+// Microbenchmarks of grandiose's per-frame hot paths, built as the
+// grandiose_bench addon and driven by bench/native.js. Frames are synthetic
+// and owned by the mock NDI library, so the receive completions can release
+// them as usual. The interleaving utilities are loaded from the real NDI
+// library when bench/native.js can find it, as the mock's are only stand-ins.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <dlfcn.h>
+#include <cstddef>
+#include <Processing.NDI.Lib.h>
+
+#include "grandiose_util.h"
+#include "grandiose_metrics.h"
+#include "grandiose_receive.h"
+#include "grandiose_send.h"
+#include "napi.h"
+
+typedef void (*interleave16sFn)(const NDIlib_audio_frame_v2_t *, NDIlib_audio_frame_interleaved_16s_t *);
+typedef void (*interleave32fFn)(const NDIlib_audio_frame_v2_t *, NDIlib_audio_frame_interleaved_32f_t *);
+
+namespace
+{
+  using benchClock = std::chrono::steady_clock;
+
+  struct benchResult
+  {
+    uint32_t iterations = 0;
+    uint64_t nanoseconds = 0;
+    uint64_t bytes = 0;
+    // Carriers that had to be allocated, as none were spare
+    uint64_t carriersAllocated = 0;
+  };
+
+  Napi::Object resultToJs(Napi::Env env, const char *name, const benchResult &result)
+  {
+    Napi::Object js = Napi::Object::New(env);
+    double seconds = (double)result.nanoseconds / 1e9;
+    js.Set("name", name);
+    js.Set("iterations", (double)result.iterations);
+    js.Set("nsPerFrame", result.iterations > 0 ? (double)result.nanoseconds / result.iterations : 0.0);
+    js.Set("bytesPerSecond", seconds > 0 ? (double)result.bytes / seconds : 0.0);
+    js.Set("carriersAllocated", (double)result.carriersAllocated);
+    return js;
+  }
+
+  uint32_t numberOption(Napi::Object options, const char *name, uint32_t fallback)
+  {
+    Napi::Value value;
+    if (!options.Get(name).UnwrapTo(&value) || !value.IsNumber())
+      return fallback;
+    return value.As<Napi::Number>().Uint32Value();
+  }
+
+  bool booleanOption(Napi::Object options, const char *name)
+  {
+    Napi::Value value;
+    return options.Get(name).UnwrapTo(&value) && value.IsBoolean() && value.As<Napi::Boolean>().Value();
+  }
+
+  Napi::Object optionsArgument(const Napi::CallbackInfo &info)
+  {
+    if (info.Length() > 0 && info[0].IsObject())
+      return info[0].As<Napi::Object>();
+    return Napi::Object::New(info.Env());
+  }
+
+  receiverState *benchReceiver(bool zeroCopy, bool binaryHeader)
+  {
+    receiverState *r = new receiverState;
+    r->recv = ndiLib->recv_create_v3(nullptr);
+    r->zeroCopy = zeroCopy;
+    r->binaryHeader = binaryHeader;
+    return r;
+  }
+
+  // A frame as NDI would hand it over, with memory the receive path frees
+  template <typename T>
+  T *copyTemplate(const T *data, size_t size)
+  {
+    T *copy = (T *)malloc(size);
+    memcpy(copy, data, size);
+    return copy;
+  }
+
+  NDIlib_audio_frame_v3_t planarTemplate(int32_t channels, int32_t samples)
+  {
+    NDIlib_audio_frame_v3_t frame;
+    frame.sample_rate = 48000;
+    frame.no_channels = channels;
+    frame.no_samples = samples;
+    frame.timecode = 0;
+    frame.FourCC = NDIlib_FourCC_audio_type_FLTP;
+    frame.channel_stride_in_bytes = samples * (int)sizeof(float);
+    frame.p_metadata = nullptr;
+    frame.timestamp = 0;
+    float *data = (float *)malloc((size_t)frame.channel_stride_in_bytes * channels);
+    for (int32_t c = 0; c < channels; c++)
+      for (int32_t s = 0; s < samples; s++)
+        data[c * samples + s] = 0.5f * (float)sin(s * 0.01 * (c + 1));
+    frame.p_data = (uint8_t *)data;
+    return frame;
+  }
+} // namespace
+
+// videoComplete({ xres, yres, iterations, zeroCopy, binaryHeader })
+Napi::Value videoComplete(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Object options = optionsArgument(info);
+  uint32_t xres = numberOption(options, "xres", 1920);
+  uint32_t yres = numberOption(options, "yres", 1080);
+  uint32_t iterations = numberOption(options, "iterations", 100);
+
+  receiverState *receiver = benchReceiver(booleanOption(options, "zeroCopy"), booleanOption(options, "binaryHeader"));
+  size_t length = (size_t)xres * 2 * yres;
+  uint8_t *data = (uint8_t *)malloc(length);
+  memset(data, 0x80, length);
+
+  benchResult result;
+  uint64_t allocated = metrics.carriersAllocated.load();
+  for (uint32_t i = 0; i < iterations; i++)
+  {
+    Napi::HandleScope scope(env);
+    dataCarrier *c = acquireDataCarrier(receiver);
+    napi_value promise;
+    if (napi_create_promise(env, &c->_deferred, &promise) != napi_ok)
+    {
+      recycleDataCarrier(c);
+      break;
+    }
+    c->videoFrame = NDIlib_video_frame_v2_t(xres, yres, NDIlib_FourCC_video_type_UYVY, 30000, 1001,
+                                            (float)xres / yres, NDIlib_frame_format_type_progressive,
+                                            i, copyTemplate(data, length), xres * 2, nullptr, i);
+
+    benchClock::time_point start = benchClock::now();
+    videoReceiveComplete(env, napi_ok, c);
+    result.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(benchClock::now() - start).count();
+    result.bytes += length;
+    result.iterations++;
+  }
+  result.carriersAllocated = metrics.carriersAllocated.load() - allocated;
+
+  free(data);
+  releaseReceiver(receiver);
+  return resultToJs(env, "videoReceiveComplete", result);
+}
+
+// audioComplete({ channels, samples, audioFormat, iterations, binaryHeader })
+// Times convertAudio, run on the capture thread, and the completion separately
+Napi::Value audioComplete(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Object options = optionsArgument(info);
+  int32_t channels = (int32_t)numberOption(options, "channels", 2);
+  int32_t samples = (int32_t)numberOption(options, "samples", 1602);
+  uint32_t iterations = numberOption(options, "iterations", 1000);
+  Grandiose_audio_format_e audioFormat = (Grandiose_audio_format_e)numberOption(options, "audioFormat", 0);
+
+  receiverState *receiver = benchReceiver(false, booleanOption(options, "binaryHeader"));
+  NDIlib_audio_frame_v3_t source = planarTemplate(channels, samples);
+  size_t length = (size_t)source.channel_stride_in_bytes * channels;
+
+  benchResult convert, complete;
+  uint64_t allocated = metrics.carriersAllocated.load();
+  for (uint32_t i = 0; i < iterations; i++)
+  {
+    Napi::HandleScope scope(env);
+    dataCarrier *c = acquireDataCarrier(receiver);
+    c->audioFormat = audioFormat;
+    napi_value promise;
+    if (napi_create_promise(env, &c->_deferred, &promise) != napi_ok)
+    {
+      recycleDataCarrier(c);
+      break;
+    }
+    c->audioFrame = source;
+    c->audioFrame.p_data = copyTemplate(source.p_data, length);
+
+    benchClock::time_point start = benchClock::now();
+    convertAudio(c);
+    benchClock::time_point converted = benchClock::now();
+    audioReceiveComplete(env, napi_ok, c);
+    benchClock::time_point end = benchClock::now();
+
+    convert.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(converted - start).count();
+    complete.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(end - converted).count();
+    convert.bytes += length;
+    complete.bytes += length;
+    convert.iterations++;
+    complete.iterations++;
+  }
+  complete.carriersAllocated = metrics.carriersAllocated.load() - allocated;
+
+  free(source.p_data);
+  releaseReceiver(receiver);
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("convert", resultToJs(env, "convertAudio", convert));
+  result.Set("complete", resultToJs(env, "audioReceiveComplete", complete));
+  return result;
+}
+
+// interleave({ channels, samples, iterations, library })
+// The NDI utilities alone, from the library at the given path if it loads
+Napi::Value interleave(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::Object options = optionsArgument(info);
+  int32_t channels = (int32_t)numberOption(options, "channels", 2);
+  int32_t samples = (int32_t)numberOption(options, "samples", 1602);
+  uint32_t iterations = numberOption(options, "iterations", 1000);
+
+  interleave16sFn to16s = ndiLib->util_audio_to_interleaved_16s_v2;
+  interleave32fFn to32f = ndiLib->util_audio_to_interleaved_32f_v2;
+  std::string implementation = "mock";
+  Napi::Value library;
+  if (options.Get("library").UnwrapTo(&library) && library.IsString())
+  {
+    std::string path = library.As<Napi::String>().Utf8Value();
+    void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle != nullptr)
+    {
+      interleave16sFn found16s = (interleave16sFn)dlsym(handle, "NDIlib_util_audio_to_interleaved_16s_v2");
+      interleave32fFn found32f = (interleave32fFn)dlsym(handle, "NDIlib_util_audio_to_interleaved_32f_v2");
+      if (found16s != nullptr && found32f != nullptr)
+      {
+        // Left loaded, the utilities do not need the library initialised
+        to16s = found16s;
+        to32f = found32f;
+        implementation = path;
+      }
+    }
+  }
+
+  NDIlib_audio_frame_v3_t source = planarTemplate(channels, samples);
+  NDIlib_audio_frame_v2_t planar = planarAudioView(source);
+  size_t length = (size_t)source.channel_stride_in_bytes * channels;
+
+  NDIlib_audio_frame_interleaved_16s_t frame16s;
+  frame16s.reference_level = 20;
+  frame16s.p_data = (int16_t *)malloc((size_t)samples * channels * sizeof(int16_t));
+  NDIlib_audio_frame_interleaved_32f_t frame32f;
+  frame32f.p_data = (float *)malloc((size_t)samples * channels * sizeof(float));
+
+  benchResult result16s, result32f;
+  for (uint32_t i = 0; i < iterations; i++)
+  {
+    benchClock::time_point start = benchClock::now();
+    to16s(&planar, &frame16s);
+    benchClock::time_point middle = benchClock::now();
+    to32f(&planar, &frame32f);
+    benchClock::time_point end = benchClock::now();
+
+    result16s.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(middle - start).count();
+    result32f.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle).count();
+    result16s.bytes += length;
+    result32f.bytes += length;
+    result16s.iterations++;
+    result32f.iterations++;
+  }
+
+  free(frame16s.p_data);
+  free(frame32f.p_data);
+  free(source.p_data);
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("implementation", implementation);
+  result.Set("interleaved16s", resultToJs(env, "NDIlib_util_audio_to_interleaved_16s_v2", result16s));
+  result.Set("interleaved32f", resultToJs(env, "NDIlib_util_audio_to_interleaved_32f_v2", result32f));
+  return result;
+}
+
+// videoSendParse(frame, iterations)
+Napi::Value videoSendParse(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsObject())
+  {
+    Napi::TypeError::New(env, "Expected a video frame to parse").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  uint32_t iterations = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().Uint32Value() : 10000;
+
+  benchResult result;
+  for (uint32_t i = 0; i < iterations; i++)
+  {
+    Napi::HandleScope scope(env);
+    sendDataCarrier c;
+    napi_value buffer;
+    benchClock::time_point start = benchClock::now();
+    videoFrameFromJs(env, info[0], &c, &buffer);
+    result.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(benchClock::now() - start).count();
+    if (c.status != GRANDIOSE_SUCCESS)
+    {
+      Napi::Error::New(env, c.errorMsg).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    result.bytes += (size_t)c.videoFrame.line_stride_in_bytes * c.videoFrame.yres;
+    result.iterations++;
+  }
+
+  return resultToJs(env, "videoFrameFromJs", result);
+}
+
+// Classes for binary header frames, as index.js registers with grandiose
+Napi::Value setFrameClasses(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsFunction() || !info[1].IsFunction())
+  {
+    Napi::TypeError::New(env, "Expected video and audio frame classes").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  GrandioseInstanceData *instance = env.GetInstanceData<GrandioseInstanceData>();
+  instance->videoFrame = Napi::Persistent(info[0].As<Napi::Function>());
+  instance->audioFrame = Napi::Persistent(info[1].As<Napi::Function>());
+  return env.Undefined();
+}
+
+Napi::Object Init(Napi::Env env, Napi::Object exports)
+{
+  // Built with GRANDIOSE_NDI_STATIC, so this is the linked mock
+  std::string error;
+  if (!loadNdi(error))
+  {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return exports;
+  }
+  env.SetInstanceData<GrandioseInstanceData>(new GrandioseInstanceData{});
+
+  exports.Set("videoComplete", Napi::Function::New(env, videoComplete));
+  exports.Set("audioComplete", Napi::Function::New(env, audioComplete));
+  exports.Set("interleave", Napi::Function::New(env, interleave));
+  exports.Set("videoSendParse", Napi::Function::New(env, videoSendParse));
+  exports.Set("setFrameClasses", Napi::Function::New(env, setFrameClasses));
+  return exports;
+}
+
+NODE_API_MODULE(grandiose_bench, Init)
@@ -1,22 +1,40 @@
 {
+  "variables": {
+    # build the ndi_mock library as well, with node-gyp rebuild --mock_ndi=1
+    "mock_ndi%": 0,
+    # build grandiose_bench as well, with node-gyp rebuild --bench_native=1
+    "bench_native%": 0,
+    "grandiose_sources": [
+      "src/grandiose_util.cc",
+      "src/grandiose_ndi.cc",
+      "src/grandiose_histogram.cc",
+      "src/grandiose_trace.cc",
+      "src/grandiose_log.cc",
+      "src/grandiose_metrics.cc",
+      "src/grandiose_executor.cc",
+      "src/grandiose_find.cc",
+      "src/grandiose_send.cc",
+      "src/grandiose_receive.cc",
+      "src/grandiose_receiver.cc",
+      "src/grandiose_stream.cc",
+      "src/grandiose_framesync.cc",
+      "src/grandiose_relay.cc",
+      "src/grandiose_routing.cc"
+    ]
+  },
   "targets": [
     {
       "target_name": "grandiose",
-      "sources": [
-        "src/grandiose_util.cc",
-        "src/grandiose_find.cc",
-        "src/grandiose_send.cc",
-        "src/grandiose_receive.cc",
-        "src/grandiose.cc"
-      ],
+      "sources": [ "<@(grandiose_sources)", "src/grandiose.cc" ],
       "include_dirs": [ "include", "<!(node -p \"require('node-addon-api').include_dir\")" ],
       "defines": [
         "NAPI_DISABLE_CPP_EXCEPTIONS",
         "NODE_ADDON_API_ENABLE_MAYBE"
       ],
       "conditions":[
+        # NDI is not linked, but loaded on first use, see src/grandiose_ndi.h
         ["OS=='win'", {
-          # windows can't do rpath, so needs to be copied next to the .node file
+          # loaded from next to the .node file
           "copies":[
             {
               "destination": "build/Release",
@@ -24,24 +42,14 @@
                 "lib/win_x64/Processing.NDI.Lib.x64.dll"
               ]
             }
-          ],
-          "link_settings": {
-            "libraries": [ "Processing.NDI.Lib.x64.lib" ],
-            "library_dirs": [ "lib/win_x64" ]
-          },
+          ]
         }],
         ["OS=='linux'", {
           "cflags": [
             "-Wno-write-strings" # temporary, until all the C style code is replaced
           ],
           "link_settings": {
-            "libraries": [
-              "<(module_root_dir)/lib/linux_x64/libndi.so.5"
-            ],
-            "ldflags": [
-              "-L<@(module_root_dir)/lib/linux_x64",
-              "-Wl,-rpath=\\$$ORIGIN/../../lib/linux_x64",
-            ]
+            "libraries": [ "-ldl" ]
           },
         }],
         ["OS=='mac'", {
@@ -52,18 +60,84 @@
               "-std=c++14",
               "-stdlib=libc++",
               "-fexceptions"
-            ],
-            "OTHER_LDFLAGS": [
-              "-Wl,-rpath,@loader_path/../../lib/mac_universal"
             ]
-          },
-          "link_settings": {
-            "libraries": [
-              "<(module_root_dir)/lib/mac_universal/libndi.dylib"
-            ],
           }
         }]
       ]
     }
+  ],
+  "conditions": [
+    # A stand-in for libndi, loaded in its place by setting GRANDIOSE_MOCK=1
+    # or setLibraryPath(), for testing and benchmarking without the SDK or a
+    # network
+    ["mock_ndi==1 and OS!='win'", {
+      "targets": [
+        {
+          "target_name": "ndi_mock",
+          "type": "loadable_module",
+          "product_extension": "so",
+          "sources": [ "mock/ndi_mock.cc" ],
+          "include_dirs": [ "include" ],
+          "conditions": [
+            ["OS=='linux'", {
+              "cflags": [
+                "-Wno-write-strings"
+              ],
+              "link_settings": {
+                "libraries": [ "-lpthread" ]
+              }
+            }],
+            ["OS=='mac'", {
+              "cflags+": ["-fvisibility=hidden"],
+              "xcode_settings": {
+                "GCC_SYMBOLS_PRIVATE_EXTERN": "YES",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++14",
+                  "-stdlib=libc++",
+                  "-fexceptions"
+                ]
+              }
+            }]
+          ]
+        }
+      ]
+    }],
+    # Microbenchmarks of the per-frame paths, loaded by bench/native.js. N-API
+    # values need a Node.js runtime, so this is an addon rather than an executable.
+    ["bench_native==1 and OS!='win'", {
+      "targets": [
+        {
+          "target_name": "grandiose_bench",
+          "sources": [ "<@(grandiose_sources)", "mock/ndi_mock.cc", "bench/native_bench.cc" ],
+          "include_dirs": [ "include", "src", "<!(node -p \"require('node-addon-api').include_dir\")" ],
+          "defines": [
+            "NAPI_DISABLE_CPP_EXCEPTIONS",
+            "NODE_ADDON_API_ENABLE_MAYBE",
+            "GRANDIOSE_NDI_STATIC" # uses the linked mock rather than loading a library
+          ],
+          "conditions": [
+            ["OS=='linux'", {
+              "cflags": [
+                "-Wno-write-strings"
+              ],
+              "link_settings": {
+                "libraries": [ "-lpthread", "-ldl" ]
+              }
+            }],
+            ["OS=='mac'", {
+              "cflags+": ["-fvisibility=hidden"],
+              "xcode_settings": {
+                "GCC_SYMBOLS_PRIVATE_EXTERN": "YES",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++14",
+                  "-stdlib=libc++",
+                  "-fexceptions"
+                ]
+              }
+            }]
+          ]
+        }
+      ]
+    }]
   ]
 }
@@ -1,3 +1,5 @@
+import { EventEmitter } from 'events'
+
 export interface AudioFrame {
   type: 'audio'
   audioFormat: AudioFormat
@@ -8,7 +10,10 @@ export interface AudioFrame {
   channelStrideInBytes: number
   timestamp: [number, number] // PTP timestamp
   timecode: [number, number] // timecode as PTP value
+  rawTimestamp?: bigint // 100ns units, only with binaryHeader
+  rawTimecode?: bigint // 100ns units, only with binaryHeader
   data: Buffer
+  channelData?: Float32Array[] // one view of data per channel, AUDIO_FORMAT_FLOAT_32_SEPARATE only
 }
 
 export interface VideoFrame {
@@ -23,11 +28,13 @@ export interface VideoFrame {
   frameFormatType: FrameType
   timecode: [ number, number ] // Measured in nanoseconds
   lineStrideBytes: number
+  skipped?: number // frames dropped to reach this one, only with latest
+  rawTimestamp?: bigint // 100ns units, only with binaryHeader
+  rawTimecode?: bigint // 100ns units, only with binaryHeader
   data: Buffer
 }
 
 export interface Receiver {
-  embedded: unknown
   video: (timeout?: number) => Promise<VideoFrame>
   audio: (params: {
     audioFormat: AudioFormat
@@ -35,16 +42,146 @@ export interface Receiver {
   }, timeout?: number) => Promise<AudioFrame>
   metadata: any
   data: any
+  stream: (params: ReceiverStreamOptions | undefined,
+    callback: (err: Error | null, frame?: VideoFrame | AudioFrame | any) => void) => void
+  stopStream: () => void
+  frameSync: () => FrameSync
+  relay: (sender: Sender, options?: RelayOptions) => Relay
+  stats: () => ReceiverStats
+  latency: () => { video: ReceiveLatency, audio: ReceiveLatency }
+  resetLatency: () => void
   source: Source
   colorFormat: ColorFormat
   bandwidth: Bandwidth
   allowVideoFields: boolean
+  zeroCopy: boolean
+  binaryHeader: boolean
+  latest: boolean
+  name?: string
+}
+
+export interface FrameCounts {
+  video: number
+  audio: number
+  metadata: number
+}
+
+export interface ReceiverStats {
+  total: FrameCounts // frames received by NDI
+  dropped: FrameCounts // frames dropped by NDI
+  queue: FrameCounts // frames waiting to be captured
+  grandiose: {
+    captures: number
+    timeouts: number
+    captureTime: number // microseconds
+    completions: number
+    completionTime: number // microseconds
+    bytesCopied: number
+    skipped: number
+    streamDropped: number
+  }
+}
+
+export interface RelayOptions {
+  video?: boolean // default true
+  audio?: boolean // default true
+  metadata?: boolean // default true
+}
+
+export interface Relay {
+  start: () => void
+  stop: () => void
+  stats: () => RelayStats
+  running: boolean
+}
+
+// Returned by grandiose.relay(), which creates the relay's sender
+export interface OwnedRelay extends Relay {
+  // Stops the relay and destroys its sender
+  destroy: () => Promise<void>
+}
+
+export interface RelayStats {
+  running: boolean
+  video: number // frames relayed
+  audio: number
+  metadata: number
+  connectionLost: number
+  sendTime: number // microseconds
+}
+
+// Times in microseconds
+export interface LatencyHistogram {
+  count: number
+  min: number
+  max: number
+  mean: number
+  p50: number
+  p90: number
+  p99: number
+  p999: number
+  buckets: [number, number][] // [ upper limit, count ] for each non-empty bucket
+}
+
+export interface ReceiveLatency {
+  ndi: LatencyHistogram // NDI timestamp to capture
+  queue: LatencyHistogram // capture to completion starting
+  complete: LatencyHistogram // building the frame on the JavaScript thread
+  total: LatencyHistogram // capture to promise resolution
+}
+
+export interface SendLatency {
+  queue: LatencyHistogram // call to the send starting
+  send: LatencyHistogram // the NDI send, including clocking
+  total: LatencyHistogram // call to promise resolution
+}
+
+export interface FramePoolStats {
+  hits: number // frames reused from the pool
+  misses: number // frames newly allocated
+  recycled: number // frames returned to the pool after sending
+  spare: number
+  outstanding: number
+  frameSize: number // bytes
+}
+
+export interface ReceiverStreamOptions {
+  video?: boolean
+  audio?: boolean
+  metadata?: boolean
+  audioFormat?: AudioFormat
+  referenceLevel?: number
+  ringSize?: number
+  wait?: number
+}
+
+export interface FrameSync {
+  // Latest video frame, or null if none has been received yet
+  video: (params?: {
+    frameFormat?: FrameType
+  }) => VideoFrame | null
+  // Exactly params.samples samples, resampled to the caller's clock
+  audio: (params: {
+    samples: number
+    sampleRate?: number
+    channels?: number
+    audioFormat?: AudioFormat
+    referenceLevel?: number
+  }) => AudioFrame
+  audioQueueDepth: () => number
+  destroy: () => void
 }
 
 export interface Sender {
   embedded: unknown
   destroy: () => Promise<void>
   video: (frame: VideoFrame) => Promise<void>
+  videoAsync: (frame: VideoFrame) => void
+  flushVideo: () => void
+  allocFrame: (format: { xres: number, yres: number, fourCC: FourCC, lineStrideBytes?: number }) => Buffer
+  framePoolStats: () => FramePoolStats
+  latency: () => { video: SendLatency, audio: SendLatency }
+  resetLatency: () => void
   audio: (frame: AudioFrame) => Promise<void>
   name: string
   groups?: string | string[]
@@ -55,9 +192,8 @@ export interface Sender {
 export interface Routing {
   name: string
   groups?: string
-  embedded: unknown
   destroy: () => Promise<void>
-  change: (Source) => number
+  change: (source: Source) => boolean
   clear: () => boolean
   connections: () => number
   sourcename: () => string
@@ -137,6 +273,9 @@ export function receive(params: {
   colorFormat?: ColorFormat
   bandwidth?: Bandwidth
   allowVideoFields?: boolean
+  zeroCopy?: boolean
+  binaryHeader?: boolean
+  latest?: boolean
   name?: string
 }): Promise<Receiver>
 
@@ -150,7 +289,55 @@ export function send(params: {
 export function routing(params: {
   name: string
   groups?: string | string[]
-}): Routing
+}): Promise<Routing>
+
+export namespace routing {
+  /**
+   * Switch many routers at once on a single native call, clearing those
+   * without a source. Resolves with whether each change succeeded.
+   */
+  function salvo(changes: Array<{ router: Routing, source?: Source | null }>): Promise<boolean[]>
+}
+
+export interface ExecutorStats {
+  // Number of executor threads started
+  threads: number
+  // Threads currently running a blocking NDI call
+  busy: number
+  // Work waiting for a free thread
+  queued: number
+  // Total work completed since the executor started
+  completed: number
+  // Microseconds spent running work, summed across threads
+  busyTime: number
+}
+
+export function relay(source: Source, name: string, options?: RelayOptions): Promise<OwnedRelay>
+export function executorStats(): ExecutorStats
+// Counters for the whole process in Prometheus text exposition format
+export function metrics(): string
+// Where to load the NDI(tm) library from on first use, or null to search for it
+export function setLibraryPath(path: string | null): void
+
+export type LogLevel = 'off' | 'error' | 'warn' | 'info' | 'debug'
+
+export interface LogEntry {
+  level: Exclude<LogLevel, 'off'>
+  message: string
+  time: number // milliseconds since the epoch
+}
+
+export function setLogLevel(level: LogLevel): void
+// Receive messages in batches rather than on stderr, null to go back to stderr
+export function setLogCallback(callback: ((entries: LogEntry[]) => void) | null): void
+
+export const trace: {
+  // bufferSize is the number of events kept per thread, default 16384
+  start: (options?: { bufferSize?: number }) => void
+  stop: () => void
+  // Chrome trace JSON of the events recorded since the last dump
+  dump: () => string
+}
 
 /** @deprecated use GrandioseFinder instead */
 export function find(params: GrandioseFinderOptions, waitMs?: number): Promise<Array<Source>>
@@ -163,15 +350,28 @@ export interface GrandioseFinderOptions {
   // Specific IP addresses or machine names to check
   // These are possibly on a different VLAN and not visible over MDNS
   extraIPs?: string[]
+  // GrandioseFinder.create() only: wait for this many sources...
+  minSources?: number
+  // ...for at most this many milliseconds
+  timeout?: number
 }
 
 /**
  * An instance of the NDI source finder.
  * This will monitor for sources in the background, and you can poll it for the current list at useful times.
+ * Listening for 'added' or 'removed' starts a native thread that emits only the sources that have changed.
  */
-export class GrandioseFinder{
+export class GrandioseFinder extends EventEmitter {
   constructor(options?: GrandioseFinderOptions)
 
+  /**
+   * Create a finder without blocking the event loop, optionally waiting for sources
+   */
+  static create(options?: GrandioseFinderOptions): Promise<GrandioseFinder>
+
+  on(event: 'added' | 'removed', listener: (sources: Array<Source>) => void): this
+  once(event: 'added' | 'removed', listener: (sources: Array<Source>) => void): this
+
   /**
    * Dispose of the finder once you are finished with it
    * Failing to do so will block the application from terminating
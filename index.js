@@ -17,13 +17,12 @@ const addon = require("pkg-prebuilds")(
   __dirname,
   require("./binding-options")
 );
-const { promisify } = require('util')
-const setTimeoutPromise = promisify(setTimeout)
-
-const addon = require('bindings')({
-  bindings: "grandiose",
-  module_root: path.resolve(__dirname)
-});
+// GRANDIOSE_MOCK=1 points the addon at the mock NDI library instead, see
+// mock/ndi_mock.cc. Nothing is loaded until NDI is first used.
+if (process.env.GRANDIOSE_MOCK === '1') {
+  addon.setLibraryPath(require('path').join(__dirname, 'build/Release/ndi_mock.so'))
+}
+const EventEmitter = require('events')
 
 const COLOR_FORMAT_BGRX_BGRA = 0; // No alpha channel: BGRX, Alpha channel: BGRA
 const COLOR_FORMAT_UYVY_BGRA = 1; // No alpha channel: UYVY, Alpha channel: BGRA
@@ -74,16 +73,116 @@ const AUDIO_FORMAT_FLOAT_32_INTERLEAVED = 1;
 // Channels stored as channel-interleaved 16-bit integer values
 const AUDIO_FORMAT_INT_16_INTERLEAVED = 2;
 
-class GrandioseFinder{
+// Split a 64-bit count of 100ns units into [ seconds, nanoseconds ]
+const ticksToPTP = (ticks) =>
+  [ Number(ticks / 10000000n), Number(ticks % 10000000n) * 100 ]
+
+// Frames from receivers created with binaryHeader: true. The native side
+// fills a fixed layout header, see videoFrameHeader and audioFrameHeader in
+// src/grandiose_receive.h, and the fields are only decoded when read.
+class VideoFrame {
+  #header
+
+  constructor(header, data, metadata) {
+    this.#header = new DataView(header)
+    this.data = data
+    if (metadata !== undefined) this.metadata = metadata
+  }
+
+  get type() { return 'video' }
+  get xres() { return this.#header.getInt32(0, true) }
+  get yres() { return this.#header.getInt32(4, true) }
+  get frameRateN() { return this.#header.getInt32(8, true) }
+  get frameRateD() { return this.#header.getInt32(12, true) }
+  get pictureAspectRatio() { return this.#header.getFloat32(16, true) }
+  get frameFormatType() { return this.#header.getInt32(20, true) }
+  get fourCC() { return this.#header.getInt32(24, true) }
+  get lineStrideBytes() { return this.#header.getInt32(28, true) }
+  get timestamp() { return ticksToPTP(this.rawTimestamp) }
+  get timecode() { return ticksToPTP(this.rawTimecode) }
+  // 64-bit values in 100ns units
+  get rawTimestamp() { return this.#header.getBigInt64(32, true) }
+  get rawTimecode() { return this.#header.getBigInt64(40, true) }
+}
+
+class AudioFrame {
+  #header
+  #channelData
+
+  constructor(header, data, metadata) {
+    this.#header = new DataView(header)
+    this.data = data
+    if (metadata !== undefined) this.metadata = metadata
+  }
+
+  get type() { return 'audio' }
+  get sampleRate() { return this.#header.getInt32(0, true) }
+  get channels() { return this.#header.getInt32(4, true) }
+  get samples() { return this.#header.getInt32(8, true) }
+  get channelStrideInBytes() { return this.#header.getInt32(12, true) }
+  get audioFormat() { return this.#header.getInt32(16, true) }
+  get referenceLevel() {
+    return this.audioFormat === AUDIO_FORMAT_INT_16_INTERLEAVED ?
+      this.#header.getInt32(20, true) : undefined
+  }
+  get timestamp() { return ticksToPTP(this.rawTimestamp) }
+  get timecode() { return ticksToPTP(this.rawTimecode) }
+  // 64-bit values in 100ns units
+  get rawTimestamp() { return this.#header.getBigInt64(24, true) }
+  get rawTimecode() { return this.#header.getBigInt64(32, true) }
+  // Views of each channel of planar audio, sharing memory with data
+  get channelData() {
+    if (this.audioFormat !== AUDIO_FORMAT_FLOAT_32_SEPARATE) return undefined
+    if (this.#channelData === undefined) {
+      const stride = this.channelStrideInBytes
+      this.#channelData = []
+      for (let i = 0; i < this.channels; i++) {
+        this.#channelData.push(new Float32Array(this.data.buffer,
+          this.data.byteOffset + i * stride, this.samples))
+      }
+    }
+    return this.#channelData
+  }
+}
+
+addon.setFrameClasses(VideoFrame, AudioFrame)
+
+function nativeFinderOptions(options) {
+  return options ? {
+    showLocalSources: options.showLocalSources,
+    groups: Array.isArray(options.groups) ? options.groups.join(','):options.groups,
+    extraIPs: Array.isArray(options.extraIPs) ? options.extraIPs.join(','):options.extraIPs,
+    minSources: options.minSources,
+    timeout: options.timeout,
+  } : undefined
+}
+
+// Emits 'added' and 'removed' with arrays of sources once anything listens
+// for them, from a native thread watching the network
+class GrandioseFinder extends EventEmitter {
   #addon
+  #watching = false
+
+  constructor(options, native) {
+    super()
+    this.#addon = native ?? new addon.GrandioseFinder(nativeFinderOptions(options))
 
-  constructor(options) {
-    const newOptions = options ? {
-      showLocalSources: options.showLocalSources,
-      groups: Array.isArray(options.groups) ? options.groups.join(','):options.groups,
-      extraIPs: Array.isArray(options.extraIPs) ? options.extraIPs.join(','):options.extraIPs,
-    } : undefined
-    this.#addon = new addon.GrandioseFinder(newOptions)
+    this.on('newListener', (event) => {
+      if ((event === 'added' || event === 'removed') && !this.#watching) {
+        this.#watching = true
+        this.#addon.watch((added, removed) => {
+          if (added.length > 0) this.emit('added', added)
+          if (removed.length > 0) this.emit('removed', removed)
+        })
+      }
+    })
+  }
+
+  // Resolves once the finder has been created, and optionally once at least
+  // options.minSources have been found or options.timeout ms have passed
+  static async create(options) {
+    const native = await addon.GrandioseFinder.create(nativeFinderOptions(options))
+    return new GrandioseFinder(options, native)
   }
 
   dispose(...args) {
@@ -101,28 +200,48 @@ async function findCompat(options = {}, waitMs = 0) {
   const finder = new GrandioseFinder(options)
 
   if (!waitMs || typeof waitMs !== 'number') waitMs = 10000
-  const maxTime = Date.now() + waitMs
 
   try {
-    // Until the timeout has been reached
-    while(Date.now() < maxTime) {
-      // Sleep for a short period
-      await setTimeoutPromise(50)
-
-      // Check if any have been found
-      const sources = finder.getCurrentSources()
-      if (sources.length > 0) {
-        return sources
-      }
-    }
-
-    throw new Error('No sources were found')
-
+    // Resolve with the first sources found, or give up at the timeout
+    return await new Promise((resolve, reject) => {
+      const timer = setTimeout(() => reject(new Error('No sources were found')), waitMs)
+      finder.once('added', () => {
+        clearTimeout(timer)
+        resolve(finder.getCurrentSources())
+      })
+    })
   } finally {
     finder.dispose()
   }
 }
 
+function routing(params) {
+  if (params && Array.isArray(params.groups)) {
+    params = { ...params, groups: params.groups.join(',') }
+  }
+  return addon.routing(params)
+}
+routing.salvo = addon.routingSalvo
+
+// Re-publish a source under a new name, relaying its frames natively. The
+// relay owns its sender, which destroy() takes off the network.
+async function relay(source, name, options) {
+  const receiver = await addon.receive({ source })
+  const sender = await addon.send({ name })
+  let relayed
+  try {
+    relayed = receiver.relay(sender, options)
+  } catch (err) {
+    await sender.destroy()
+    throw err
+  }
+  relayed.destroy = async () => {
+    relayed.stop()
+    await sender.destroy()
+  }
+  return relayed
+}
+
 module.exports = {
   version: addon.version,
   find: findCompat,
@@ -130,10 +249,20 @@ module.exports = {
   isSupportedCPU: addon.isSupportedCPU,
   initialize: addon.initialize,
   destroy: addon.destroy,
-  find: find,
   receive: addon.receive,
   send: addon.send,
-  routing: addon.routing,
+  routing,
+  relay,
+  executorStats: addon.executorStats,
+  metrics: addon.metrics,
+  setLibraryPath: addon.setLibraryPath,
+  setLogLevel: addon.setLogLevel,
+  setLogCallback: addon.setLogCallback,
+  trace: {
+    start: addon.traceStart,
+    stop: addon.traceStop,
+    dump: addon.traceDump,
+  },
   COLOR_FORMAT_BGRX_BGRA, COLOR_FORMAT_UYVY_BGRA,
   COLOR_FORMAT_RGBX_RGBA, COLOR_FORMAT_UYVY_RGBA,
   COLOR_FORMAT_BGRX_BGRA_FLIPPED, COLOR_FORMAT_FASTEST,
@@ -0,0 +1,1163 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+// A stand-in for the parts of libndi that grandiose uses, built as the
+// ndi_mock library that grandiose loads instead of the SDK when pointed at it,
+// see src/grandiose_ndi.h. Nothing touches the network:
+//
+//  - GRANDIOSE_MOCK_SOURCES synthetic sources (default 1), named
+//    "GRANDIOSE-MOCK (Synthetic <n>)", generate UYVY (or BGRX/RGBX) video and
+//    planar float audio at the rate a receiver captures them, paced by the
+//    configured frame rate.
+//  - Senders created in the process are sources too, and every frame sent is
+//    copied to the receivers connected to them, so a sender and a receiver
+//    make an in-memory loopback.
+//  - Routers are sources that forward whatever they have been switched to.
+//
+// The synthetic format is configured from the environment when the library
+// is initialised: GRANDIOSE_MOCK_XRES, GRANDIOSE_MOCK_YRES,
+// GRANDIOSE_MOCK_FRAME_RATE_N, GRANDIOSE_MOCK_FRAME_RATE_D,
+// GRANDIOSE_MOCK_SAMPLE_RATE and GRANDIOSE_MOCK_CHANNELS. The luma of every
+// pixel of synthetic video frame n is 16 + n % 220, so that tests can tell
+// which frame they have been given.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <Processing.NDI.Lib.h>
+
+#define MOCK_HOST "GRANDIOSE-MOCK"
+#define MOCK_URL_BASE "127.0.0.1:"
+// Frames of each type queued for a receiver before the oldest are dropped
+#define MOCK_QUEUE_DEPTH 8
+// Polling interval while waiting for connections or tallies
+#define MOCK_POLL 10
+
+using mockClock = std::chrono::steady_clock;
+
+namespace
+{
+
+  struct mockConfig
+  {
+    int xres = 1920;
+    int yres = 1080;
+    int frameRateN = 30000;
+    int frameRateD = 1001;
+    int sampleRate = 48000;
+    int channels = 2;
+    int sources = 1;
+  };
+
+  // A source that can be found and connected to
+  struct mockSource
+  {
+    std::string name;
+    std::string url;
+    bool synthetic = false;
+    bool local = true;
+    bool router = false;
+    std::string route; // routers only, empty while cleared
+  };
+
+  struct mockVideo
+  {
+    uint64_t sequence;
+    NDIlib_video_frame_v2_t frame;
+  };
+
+  struct mockAudio
+  {
+    uint64_t sequence;
+    NDIlib_audio_frame_v3_t frame;
+  };
+
+  struct mockMetadata
+  {
+    uint64_t sequence;
+    NDIlib_metadata_frame_t frame;
+  };
+
+  struct mockReceiver
+  {
+    std::string connected; // guarded by the registry lock
+    NDIlib_recv_color_format_e colorFormat = NDIlib_recv_color_format_UYVY_BGRA;
+
+    std::mutex lock;
+    std::condition_variable arrived;
+    std::deque<mockVideo> video;
+    std::deque<mockAudio> audio;
+    std::deque<mockMetadata> metadata;
+    uint64_t sequence = 0;
+    NDIlib_recv_performance_t total;
+    NDIlib_recv_performance_t dropped;
+
+    // Synthetic generation, restarted on every connection
+    bool generating = false;
+    mockClock::time_point epoch;
+    int64_t videoFrames = 0;
+    int64_t audioFrames = 0;
+    int64_t audioSamples = 0;
+  };
+
+  struct mockSender
+  {
+    mockSource *source;
+    NDIlib_source_t published;
+    bool clockVideo;
+    bool clockAudio;
+    mockClock::time_point nextVideo;
+    mockClock::time_point nextAudio;
+  };
+
+  struct mockRouter
+  {
+    mockSource *source;
+    NDIlib_source_t published;
+  };
+
+  struct mockFinder
+  {
+    bool showLocal;
+    uint64_t generation = 0;
+    std::vector<std::string> names;
+    std::vector<std::string> urls;
+    std::vector<NDIlib_source_t> sources;
+  };
+
+  struct mockFramesync
+  {
+    mockReceiver *receiver;
+    NDIlib_video_frame_v2_t last{0, 0};
+    bool hasVideo = false;
+    int sampleRate = 0;
+    std::vector<std::deque<float>> audio;
+  };
+
+  mockConfig config;
+  std::once_flag configured;
+
+  // The registry lock guards sources, receivers and every receiver's
+  // connection, and is always taken before a receiver's own lock
+  std::mutex registry;
+  std::condition_variable sourcesChanged;
+  std::map<std::string, mockSource *> sources;
+  std::set<mockReceiver *> receivers;
+  uint64_t generation = 1;
+  int nextPort = 5961;
+
+  int envInt(const char *name, int fallback)
+  {
+    const char *value = getenv(name);
+    if (value == nullptr || atoi(value) <= 0)
+      return fallback;
+    return atoi(value);
+  }
+
+  void configure()
+  {
+    std::call_once(configured, []()
+                   {
+      config.xres = envInt("GRANDIOSE_MOCK_XRES", config.xres);
+      config.yres = envInt("GRANDIOSE_MOCK_YRES", config.yres);
+      config.frameRateN = envInt("GRANDIOSE_MOCK_FRAME_RATE_N", config.frameRateN);
+      config.frameRateD = envInt("GRANDIOSE_MOCK_FRAME_RATE_D", config.frameRateD);
+      config.sampleRate = envInt("GRANDIOSE_MOCK_SAMPLE_RATE", config.sampleRate);
+      config.channels = envInt("GRANDIOSE_MOCK_CHANNELS", config.channels);
+      config.sources = envInt("GRANDIOSE_MOCK_SOURCES", config.sources);
+
+      std::lock_guard<std::mutex> guard(registry);
+      for (int i = 1; i <= config.sources; i++)
+      {
+        mockSource *source = new mockSource;
+        source->name = std::string(MOCK_HOST " (Synthetic ") + std::to_string(i) + ")";
+        source->url = MOCK_URL_BASE + std::to_string(nextPort++);
+        source->synthetic = true;
+        source->local = false;
+        sources[source->name] = source;
+      } });
+  }
+
+  // Must hold the registry lock. Follows routers to the source that frames
+  // actually come from, or nullptr if there is none.
+  mockSource *resolve(const std::string &name)
+  {
+    std::string current = name;
+    for (int hops = 0; hops < 8; hops++)
+    {
+      auto found = sources.find(current);
+      if (found == sources.end())
+        return nullptr;
+      if (!found->second->router)
+        return found->second;
+      current = found->second->route;
+    }
+    return nullptr;
+  }
+
+  mockSource *registerSource(const char *name, bool router)
+  {
+    std::string fullName = std::string(MOCK_HOST " (") + (name != nullptr ? name : "grandiose") + ")";
+    std::lock_guard<std::mutex> guard(registry);
+    if (sources.count(fullName) > 0)
+      return nullptr;
+
+    mockSource *source = new mockSource;
+    source->name = fullName;
+    source->url = MOCK_URL_BASE + std::to_string(nextPort++);
+    source->router = router;
+    sources[fullName] = source;
+    generation++;
+    sourcesChanged.notify_all();
+    return source;
+  }
+
+  void unregisterSource(mockSource *source)
+  {
+    std::lock_guard<std::mutex> guard(registry);
+    sources.erase(source->name);
+    generation++;
+    sourcesChanged.notify_all();
+    delete source;
+  }
+
+  int countConnections(const std::string &name)
+  {
+    std::lock_guard<std::mutex> guard(registry);
+    mockSource *target = resolve(name);
+    int count = 0;
+    for (mockReceiver *receiver : receivers)
+      if (receiver->connected == name || (target != nullptr && resolve(receiver->connected) == target))
+        count++;
+    return count;
+  }
+
+  int64_t ticksSince(mockClock::time_point epoch, mockClock::time_point now)
+  {
+    // 100ns units, as used for NDI timecodes and timestamps
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now - epoch).count() / 100;
+  }
+
+  int64_t wallTicks()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+               .count() /
+           100;
+  }
+
+  size_t videoFrameSize(const NDIlib_video_frame_v2_t &frame, int stride)
+  {
+    size_t plane = (size_t)stride * frame.yres;
+    switch (frame.FourCC)
+    {
+    case NDIlib_FourCC_video_type_UYVA:
+      return plane + (size_t)frame.xres * frame.yres;
+    case NDIlib_FourCC_video_type_P216:
+      return plane * 2;
+    case NDIlib_FourCC_video_type_PA16:
+      return plane * 3;
+    case NDIlib_FourCC_video_type_YV12:
+    case NDIlib_FourCC_video_type_I420:
+    case NDIlib_FourCC_video_type_NV12:
+      return plane + plane / 2;
+    default:
+      return plane;
+    }
+  }
+
+  int defaultStride(const NDIlib_video_frame_v2_t &frame)
+  {
+    switch (frame.FourCC)
+    {
+    case NDIlib_FourCC_video_type_BGRA:
+    case NDIlib_FourCC_video_type_BGRX:
+    case NDIlib_FourCC_video_type_RGBA:
+    case NDIlib_FourCC_video_type_RGBX:
+      return frame.xres * 4;
+    case NDIlib_FourCC_video_type_P216:
+    case NDIlib_FourCC_video_type_PA16:
+      return frame.xres * 2;
+    case NDIlib_FourCC_video_type_YV12:
+    case NDIlib_FourCC_video_type_I420:
+    case NDIlib_FourCC_video_type_NV12:
+      return frame.xres;
+    default:
+      return frame.xres * 2;
+    }
+  }
+
+  char *copyString(const char *value)
+  {
+    if (value == nullptr)
+      return nullptr;
+    size_t length = strlen(value) + 1;
+    char *copy = (char *)malloc(length);
+    memcpy(copy, value, length);
+    return copy;
+  }
+
+  NDIlib_video_frame_v2_t copyVideo(const NDIlib_video_frame_v2_t &frame)
+  {
+    NDIlib_video_frame_v2_t copy = frame;
+    copy.line_stride_in_bytes = frame.line_stride_in_bytes > 0 ? frame.line_stride_in_bytes : defaultStride(frame);
+    size_t size = videoFrameSize(frame, copy.line_stride_in_bytes);
+    copy.p_data = (uint8_t *)malloc(size);
+    if (frame.p_data != nullptr)
+      memcpy(copy.p_data, frame.p_data, size);
+    copy.p_metadata = copyString(frame.p_metadata);
+    return copy;
+  }
+
+  NDIlib_audio_frame_v3_t copyAudio(const NDIlib_audio_frame_v3_t &frame)
+  {
+    NDIlib_audio_frame_v3_t copy = frame;
+    int stride = frame.channel_stride_in_bytes > 0 ? frame.channel_stride_in_bytes : frame.no_samples * (int)sizeof(float);
+    size_t size = (size_t)stride * frame.no_channels;
+    copy.channel_stride_in_bytes = stride;
+    copy.p_data = (uint8_t *)malloc(size > 0 ? size : 1);
+    if (frame.p_data != nullptr)
+      memcpy(copy.p_data, frame.p_data, size);
+    copy.p_metadata = copyString(frame.p_metadata);
+    return copy;
+  }
+
+  void freeVideo(const NDIlib_video_frame_v2_t &frame)
+  {
+    free(frame.p_data);
+    free((void *)frame.p_metadata);
+  }
+
+  void freeAudio(const NDIlib_audio_frame_v3_t &frame)
+  {
+    free(frame.p_data);
+    free((void *)frame.p_metadata);
+  }
+
+  // Queue a frame for a receiver, dropping the oldest of its type when full.
+  // Must hold the receiver's lock.
+  template <typename Entry, typename Free>
+  void enqueue(mockReceiver *receiver, std::deque<Entry> &queue, Entry entry,
+               int64_t &total, int64_t &dropped, Free release)
+  {
+    if (queue.size() >= MOCK_QUEUE_DEPTH)
+    {
+      release(queue.front().frame);
+      queue.pop_front();
+      dropped++;
+    }
+    queue.push_back(entry);
+    total++;
+    receiver->arrived.notify_all();
+  }
+
+  void deliverVideo(mockReceiver *receiver, const NDIlib_video_frame_v2_t &frame)
+  {
+    mockVideo entry = {receiver->sequence++, copyVideo(frame)};
+    enqueue(receiver, receiver->video, entry, receiver->total.video_frames,
+            receiver->dropped.video_frames, freeVideo);
+  }
+
+  void deliverAudio(mockReceiver *receiver, const NDIlib_audio_frame_v3_t &frame)
+  {
+    mockAudio entry = {receiver->sequence++, copyAudio(frame)};
+    enqueue(receiver, receiver->audio, entry, receiver->total.audio_frames,
+            receiver->dropped.audio_frames, freeAudio);
+  }
+
+  void deliverMetadata(mockReceiver *receiver, const NDIlib_metadata_frame_t &frame)
+  {
+    NDIlib_metadata_frame_t copy = frame;
+    copy.p_data = copyString(frame.p_data);
+    copy.length = copy.p_data != nullptr ? (int)strlen(copy.p_data) + 1 : 0;
+    mockMetadata entry = {receiver->sequence++, copy};
+    enqueue(receiver, receiver->metadata, entry, receiver->total.metadata_frames,
+            receiver->dropped.metadata_frames, [](const NDIlib_metadata_frame_t &m)
+            { free(m.p_data); });
+  }
+
+  // Hands a frame sent by source to every receiver connected to it
+  template <typename Deliver>
+  void broadcast(mockSource *source, Deliver deliver)
+  {
+    std::lock_guard<std::mutex> guard(registry);
+    for (mockReceiver *receiver : receivers)
+    {
+      if (resolve(receiver->connected) != source)
+        continue;
+      std::lock_guard<std::mutex> receiverGuard(receiver->lock);
+      deliver(receiver);
+    }
+  }
+
+  // Waits until the next frame is due on a clocked sender, like the SDK does
+  void pace(mockClock::time_point &next, int64_t n, int64_t d)
+  {
+    if (n <= 0 || d <= 0)
+      return;
+    mockClock::time_point now = mockClock::now();
+    if (next > now)
+      std::this_thread::sleep_until(next);
+    else
+      next = now;
+    next += std::chrono::nanoseconds(d * 1000000000LL / n);
+  }
+
+  mockClock::time_point videoDue(mockReceiver *receiver, int64_t frame)
+  {
+    return receiver->epoch + std::chrono::nanoseconds(
+                                 frame * config.frameRateD * 1000000000LL / config.frameRateN);
+  }
+
+  void fillSynthetic(NDIlib_video_frame_v2_t &frame, int64_t number)
+  {
+    uint8_t luma = (uint8_t)(16 + number % 220);
+    size_t size = (size_t)frame.line_stride_in_bytes * frame.yres;
+    if (frame.FourCC == NDIlib_FourCC_video_type_UYVY)
+    {
+      uint8_t pattern[4] = {128, luma, 128, luma};
+      for (size_t i = 0; i < size; i += 4)
+        memcpy(frame.p_data + i, pattern, 4);
+    }
+    else
+    {
+      uint8_t pattern[4] = {luma, luma, luma, 255};
+      for (size_t i = 0; i < size; i += 4)
+        memcpy(frame.p_data + i, pattern, 4);
+    }
+  }
+
+  // Queues the synthetic frames that have fallen due since the receiver last
+  // captured, skipping ahead rather than building frames only to drop them.
+  // Must hold the receiver's lock.
+  void generate(mockReceiver *receiver, mockClock::time_point now)
+  {
+    int64_t due = 0;
+    while (videoDue(receiver, receiver->videoFrames + due) <= now)
+      due++;
+    if (due > MOCK_QUEUE_DEPTH)
+    {
+      receiver->dropped.video_frames += due - MOCK_QUEUE_DEPTH;
+      receiver->dropped.audio_frames += due - MOCK_QUEUE_DEPTH;
+      receiver->videoFrames += due - MOCK_QUEUE_DEPTH;
+      receiver->audioFrames += due - MOCK_QUEUE_DEPTH;
+      receiver->audioSamples = receiver->audioFrames * config.sampleRate * config.frameRateD / config.frameRateN;
+      due = MOCK_QUEUE_DEPTH;
+    }
+
+    for (; due > 0; due--)
+    {
+      int64_t number = receiver->videoFrames++;
+      int64_t timecode = ticksSince(receiver->epoch, videoDue(receiver, number));
+
+      NDIlib_video_frame_v2_t video;
+      video.xres = config.xres;
+      video.yres = config.yres;
+      video.frame_rate_N = config.frameRateN;
+      video.frame_rate_D = config.frameRateD;
+      video.picture_aspect_ratio = (float)config.xres / (float)config.yres;
+      video.frame_format_type = NDIlib_frame_format_type_progressive;
+      video.timecode = timecode;
+      video.timestamp = wallTicks();
+      video.p_metadata = nullptr;
+      switch (receiver->colorFormat)
+      {
+      case NDIlib_recv_color_format_BGRX_BGRA:
+        video.FourCC = NDIlib_FourCC_video_type_BGRX;
+        break;
+      case NDIlib_recv_color_format_RGBX_RGBA:
+        video.FourCC = NDIlib_FourCC_video_type_RGBX;
+        break;
+      default:
+        video.FourCC = NDIlib_FourCC_video_type_UYVY;
+        break;
+      }
+      video.line_stride_in_bytes = defaultStride(video);
+      video.p_data = (uint8_t *)malloc(videoFrameSize(video, video.line_stride_in_bytes));
+      fillSynthetic(video, number);
+      mockVideo videoEntry = {receiver->sequence++, video};
+      enqueue(receiver, receiver->video, videoEntry, receiver->total.video_frames,
+              receiver->dropped.video_frames, freeVideo);
+
+      // Audio follows each video frame, covering the same span of time
+      int64_t end = (receiver->audioFrames + 1) * config.sampleRate * config.frameRateD / config.frameRateN;
+      int samples = (int)(end - receiver->audioSamples);
+      NDIlib_audio_frame_v3_t audio;
+      audio.sample_rate = config.sampleRate;
+      audio.no_channels = config.channels;
+      audio.no_samples = samples;
+      audio.timecode = timecode;
+      audio.FourCC = NDIlib_FourCC_audio_type_FLTP;
+      audio.channel_stride_in_bytes = samples * (int)sizeof(float);
+      audio.p_metadata = nullptr;
+      audio.timestamp = video.timestamp;
+      audio.p_data = (uint8_t *)malloc((size_t)audio.channel_stride_in_bytes * config.channels + 1);
+      for (int c = 0; c < config.channels; c++)
+      {
+        float *channel = (float *)(audio.p_data + c * audio.channel_stride_in_bytes);
+        for (int s = 0; s < samples; s++)
+          channel[s] = 0.1f * (float)sin(2.0 * M_PI * 440.0 * (receiver->audioSamples + s) / config.sampleRate);
+      }
+      receiver->audioSamples = end;
+      receiver->audioFrames++;
+      mockAudio audioEntry = {receiver->sequence++, audio};
+      enqueue(receiver, receiver->audio, audioEntry, receiver->total.audio_frames,
+              receiver->dropped.audio_frames, freeAudio);
+    }
+  }
+
+  NDIlib_frame_type_e capture(mockReceiver *receiver,
+                              NDIlib_video_frame_v2_t *videoData,
+                              NDIlib_audio_frame_v3_t *audioData,
+                              NDIlib_metadata_frame_t *metadataData,
+                              uint32_t timeout)
+  {
+    mockClock::time_point deadline = mockClock::now() + std::chrono::milliseconds(timeout);
+    for (;;)
+    {
+      bool synthetic;
+      {
+        std::lock_guard<std::mutex> guard(registry);
+        mockSource *source = resolve(receiver->connected);
+        synthetic = source != nullptr && source->synthetic;
+      }
+
+      std::unique_lock<std::mutex> lock(receiver->lock);
+      mockClock::time_point now = mockClock::now();
+      if (synthetic && !receiver->generating)
+      {
+        receiver->generating = true;
+        receiver->epoch = now;
+        receiver->videoFrames = receiver->audioFrames = receiver->audioSamples = 0;
+      }
+      else if (!synthetic)
+        receiver->generating = false;
+      if (synthetic && (videoData != nullptr || audioData != nullptr))
+        generate(receiver, now);
+
+      // The oldest frame of the types asked for
+      uint64_t oldest = UINT64_MAX;
+      NDIlib_frame_type_e type = NDIlib_frame_type_none;
+      if (videoData != nullptr && !receiver->video.empty() && receiver->video.front().sequence < oldest)
+      {
+        oldest = receiver->video.front().sequence;
+        type = NDIlib_frame_type_video;
+      }
+      if (audioData != nullptr && !receiver->audio.empty() && receiver->audio.front().sequence < oldest)
+      {
+        oldest = receiver->audio.front().sequence;
+        type = NDIlib_frame_type_audio;
+      }
+      if (metadataData != nullptr && !receiver->metadata.empty() && receiver->metadata.front().sequence < oldest)
+        type = NDIlib_frame_type_metadata;
+
+      switch (type)
+      {
+      case NDIlib_frame_type_video:
+        *videoData = receiver->video.front().frame;
+        receiver->video.pop_front();
+        return type;
+      case NDIlib_frame_type_audio:
+        *audioData = receiver->audio.front().frame;
+        receiver->audio.pop_front();
+        return type;
+      case NDIlib_frame_type_metadata:
+        *metadataData = receiver->metadata.front().frame;
+        receiver->metadata.pop_front();
+        return type;
+      default:
+        break;
+      }
+
+      if (now >= deadline)
+        return NDIlib_frame_type_none;
+      mockClock::time_point wake = deadline;
+      if (synthetic)
+        wake = std::min(wake, videoDue(receiver, receiver->videoFrames));
+      receiver->arrived.wait_until(lock, wake);
+    }
+  }
+
+  void clearQueues(mockReceiver *receiver)
+  {
+    std::lock_guard<std::mutex> guard(receiver->lock);
+    for (mockVideo &entry : receiver->video)
+      freeVideo(entry.frame);
+    for (mockAudio &entry : receiver->audio)
+      freeAudio(entry.frame);
+    for (mockMetadata &entry : receiver->metadata)
+      free(entry.frame.p_data);
+    receiver->video.clear();
+    receiver->audio.clear();
+    receiver->metadata.clear();
+    receiver->generating = false;
+  }
+
+  void publish(mockSource *source, NDIlib_source_t &published)
+  {
+    published.p_ndi_name = source->name.c_str();
+    published.p_url_address = source->url.c_str();
+  }
+
+} // namespace
+
+/* Library */
+
+bool NDIlib_initialize(void)
+{
+  configure();
+  return true;
+}
+
+bool NDIlib_is_supported_CPU(void)
+{
+  return true;
+}
+
+const char *NDIlib_version(void)
+{
+  return "NDI SDK mock for grandiose";
+}
+
+/* Find */
+
+NDIlib_find_instance_t NDIlib_find_create2(const NDIlib_find_create_t *p_create_settings)
+{
+  configure();
+  mockFinder *finder = new mockFinder;
+  finder->showLocal = p_create_settings == nullptr || p_create_settings->show_local_sources;
+  return (NDIlib_find_instance_t)finder;
+}
+
+void NDIlib_find_destroy(NDIlib_find_instance_t p_instance)
+{
+  delete (mockFinder *)p_instance;
+}
+
+const NDIlib_source_t *NDIlib_find_get_current_sources(NDIlib_find_instance_t p_instance, uint32_t *p_no_sources)
+{
+  mockFinder *finder = (mockFinder *)p_instance;
+  std::lock_guard<std::mutex> guard(registry);
+
+  // Valid until the next call, as with the SDK
+  finder->names.clear();
+  finder->urls.clear();
+  for (auto &entry : sources)
+  {
+    if (entry.second->local && !finder->showLocal)
+      continue;
+    finder->names.push_back(entry.second->name);
+    finder->urls.push_back(entry.second->url);
+  }
+  finder->sources.resize(finder->names.size());
+  for (size_t i = 0; i < finder->names.size(); i++)
+  {
+    finder->sources[i].p_ndi_name = finder->names[i].c_str();
+    finder->sources[i].p_url_address = finder->urls[i].c_str();
+  }
+  finder->generation = generation;
+
+  *p_no_sources = (uint32_t)finder->sources.size();
+  return finder->sources.empty() ? nullptr : finder->sources.data();
+}
+
+bool NDIlib_find_wait_for_sources(NDIlib_find_instance_t p_instance, uint32_t timeout_in_ms)
+{
+  mockFinder *finder = (mockFinder *)p_instance;
+  std::unique_lock<std::mutex> lock(registry);
+  return sourcesChanged.wait_for(lock, std::chrono::milliseconds(timeout_in_ms), [finder]()
+                                 { return generation != finder->generation; });
+}
+
+/* Send */
+
+NDIlib_send_instance_t NDIlib_send_create(const NDIlib_send_create_t *p_create_settings)
+{
+  configure();
+  mockSource *source = registerSource(p_create_settings != nullptr ? p_create_settings->p_ndi_name : nullptr, false);
+  if (source == nullptr)
+    return nullptr;
+
+  mockSender *sender = new mockSender;
+  sender->source = source;
+  publish(source, sender->published);
+  sender->clockVideo = p_create_settings == nullptr || p_create_settings->clock_video;
+  sender->clockAudio = p_create_settings == nullptr || p_create_settings->clock_audio;
+  sender->nextVideo = sender->nextAudio = mockClock::now();
+  return (NDIlib_send_instance_t)sender;
+}
+
+void NDIlib_send_destroy(NDIlib_send_instance_t p_instance)
+{
+  mockSender *sender = (mockSender *)p_instance;
+  if (sender == nullptr)
+    return;
+  unregisterSource(sender->source);
+  delete sender;
+}
+
+void NDIlib_send_send_video_v2(NDIlib_send_instance_t p_instance, const NDIlib_video_frame_v2_t *p_video_data)
+{
+  mockSender *sender = (mockSender *)p_instance;
+  if (p_video_data == nullptr)
+    return;
+  if (sender->clockVideo)
+    pace(sender->nextVideo, p_video_data->frame_rate_N, p_video_data->frame_rate_D);
+  broadcast(sender->source, [p_video_data](mockReceiver *receiver)
+            { deliverVideo(receiver, *p_video_data); });
+}
+
+// Frames are copied before returning, so the previous frame is always free
+void NDIlib_send_send_video_async_v2(NDIlib_send_instance_t p_instance, const NDIlib_video_frame_v2_t *p_video_data)
+{
+  NDIlib_send_send_video_v2(p_instance, p_video_data);
+}
+
+void NDIlib_send_send_audio_v3(NDIlib_send_instance_t p_instance, const NDIlib_audio_frame_v3_t *p_audio_data)
+{
+  mockSender *sender = (mockSender *)p_instance;
+  if (p_audio_data == nullptr)
+    return;
+  if (sender->clockAudio && p_audio_data->no_samples > 0)
+    pace(sender->nextAudio, p_audio_data->sample_rate, p_audio_data->no_samples);
+  broadcast(sender->source, [p_audio_data](mockReceiver *receiver)
+            { deliverAudio(receiver, *p_audio_data); });
+}
+
+void NDIlib_send_send_metadata(NDIlib_send_instance_t p_instance, const NDIlib_metadata_frame_t *p_metadata)
+{
+  mockSender *sender = (mockSender *)p_instance;
+  if (p_metadata == nullptr)
+    return;
+  broadcast(sender->source, [p_metadata](mockReceiver *receiver)
+            { deliverMetadata(receiver, *p_metadata); });
+}
+
+bool NDIlib_send_get_tally(NDIlib_send_instance_t p_instance, NDIlib_tally_t *p_tally, uint32_t timeout_in_ms)
+{
+  // Nothing ever puts a mock source on program or preview
+  if (p_tally != nullptr)
+  {
+    p_tally->on_program = false;
+    p_tally->on_preview = false;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(timeout_in_ms));
+  return false;
+}
+
+int NDIlib_send_get_no_connections(NDIlib_send_instance_t p_instance, uint32_t timeout_in_ms)
+{
+  mockSender *sender = (mockSender *)p_instance;
+  mockClock::time_point deadline = mockClock::now() + std::chrono::milliseconds(timeout_in_ms);
+  int connections = countConnections(sender->source->name);
+  while (connections == 0 && mockClock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(MOCK_POLL));
+    connections = countConnections(sender->source->name);
+  }
+  return connections;
+}
+
+const NDIlib_source_t *NDIlib_send_get_source_name(NDIlib_send_instance_t p_instance)
+{
+  return &((mockSender *)p_instance)->published;
+}
+
+/* Receive */
+
+NDIlib_recv_instance_t NDIlib_recv_create_v3(const NDIlib_recv_create_v3_t *p_create_settings)
+{
+  configure();
+  mockReceiver *receiver = new mockReceiver;
+  if (p_create_settings != nullptr)
+  {
+    receiver->colorFormat = p_create_settings->color_format;
+    if (p_create_settings->source_to_connect_to.p_ndi_name != nullptr)
+      receiver->connected = p_create_settings->source_to_connect_to.p_ndi_name;
+  }
+
+  std::lock_guard<std::mutex> guard(registry);
+  receivers.insert(receiver);
+  return (NDIlib_recv_instance_t)receiver;
+}
+
+void NDIlib_recv_destroy(NDIlib_recv_instance_t p_instance)
+{
+  mockReceiver *receiver = (mockReceiver *)p_instance;
+  if (receiver == nullptr)
+    return;
+  {
+    std::lock_guard<std::mutex> guard(registry);
+    receivers.erase(receiver);
+  }
+  clearQueues(receiver);
+  delete receiver;
+}
+
+void NDIlib_recv_connect(NDIlib_recv_instance_t p_instance, const NDIlib_source_t *p_src)
+{
+  mockReceiver *receiver = (mockReceiver *)p_instance;
+  {
+    std::lock_guard<std::mutex> guard(registry);
+    receiver->connected = (p_src != nullptr && p_src->p_ndi_name != nullptr) ? p_src->p_ndi_name : "";
+  }
+  clearQueues(receiver);
+  receiver->arrived.notify_all();
+}
+
+NDIlib_frame_type_e NDIlib_recv_capture_v3(NDIlib_recv_instance_t p_instance,
+                                           NDIlib_video_frame_v2_t *p_video_data,
+                                           NDIlib_audio_frame_v3_t *p_audio_data,
+                                           NDIlib_metadata_frame_t *p_metadata,
+                                           uint32_t timeout_in_ms)
+{
+  return capture((mockReceiver *)p_instance, p_video_data, p_audio_data, p_metadata, timeout_in_ms);
+}
+
+NDIlib_frame_type_e NDIlib_recv_capture_v2(NDIlib_recv_instance_t p_instance,
+                                           NDIlib_video_frame_v2_t *p_video_data,
+                                           NDIlib_audio_frame_v2_t *p_audio_data,
+                                           NDIlib_metadata_frame_t *p_metadata,
+                                           uint32_t timeout_in_ms)
+{
+  NDIlib_audio_frame_v3_t audio;
+  NDIlib_frame_type_e type = capture((mockReceiver *)p_instance, p_video_data,
+                                     p_audio_data != nullptr ? &audio : nullptr, p_metadata, timeout_in_ms);
+  if (type == NDIlib_frame_type_audio)
+  {
+    // Mock audio is always planar float, which is the v2 layout
+    p_audio_data->sample_rate = audio.sample_rate;
+    p_audio_data->no_channels = audio.no_channels;
+    p_audio_data->no_samples = audio.no_samples;
+    p_audio_data->timecode = audio.timecode;
+    p_audio_data->p_data = (float *)audio.p_data;
+    p_audio_data->channel_stride_in_bytes = audio.channel_stride_in_bytes;
+    p_audio_data->p_metadata = audio.p_metadata;
+    p_audio_data->timestamp = audio.timestamp;
+  }
+  return type;
+}
+
+void NDIlib_recv_free_video_v2(NDIlib_recv_instance_t p_instance, const NDIlib_video_frame_v2_t *p_video_data)
+{
+  if (p_video_data != nullptr)
+    freeVideo(*p_video_data);
+}
+
+void NDIlib_recv_free_audio_v3(NDIlib_recv_instance_t p_instance, const NDIlib_audio_frame_v3_t *p_audio_data)
+{
+  if (p_audio_data != nullptr)
+    freeAudio(*p_audio_data);
+}
+
+void NDIlib_recv_free_metadata(NDIlib_recv_instance_t p_instance, const NDIlib_metadata_frame_t *p_metadata)
+{
+  if (p_metadata != nullptr)
+    free(p_metadata->p_data);
+}
+
+void NDIlib_recv_get_performance(NDIlib_recv_instance_t p_instance, NDIlib_recv_performance_t *p_total, NDIlib_recv_performance_t *p_dropped)
+{
+  mockReceiver *receiver = (mockReceiver *)p_instance;
+  std::lock_guard<std::mutex> guard(receiver->lock);
+  if (p_total != nullptr)
+    *p_total = receiver->total;
+  if (p_dropped != nullptr)
+    *p_dropped = receiver->dropped;
+}
+
+void NDIlib_recv_get_queue(NDIlib_recv_instance_t p_instance, NDIlib_recv_queue_t *p_total)
+{
+  mockReceiver *receiver = (mockReceiver *)p_instance;
+  std::lock_guard<std::mutex> guard(receiver->lock);
+  p_total->video_frames = (int)receiver->video.size();
+  p_total->audio_frames = (int)receiver->audio.size();
+  p_total->metadata_frames = (int)receiver->metadata.size();
+}
+
+/* Frame sync */
+
+NDIlib_framesync_instance_t NDIlib_framesync_create(NDIlib_recv_instance_t p_receiver)
+{
+  mockFramesync *sync = new mockFramesync;
+  sync->receiver = (mockReceiver *)p_receiver;
+  return (NDIlib_framesync_instance_t)sync;
+}
+
+void NDIlib_framesync_destroy(NDIlib_framesync_instance_t p_instance)
+{
+  mockFramesync *sync = (mockFramesync *)p_instance;
+  if (sync->hasVideo)
+    freeVideo(sync->last);
+  delete sync;
+}
+
+void NDIlib_framesync_capture_video(NDIlib_framesync_instance_t p_instance,
+                                    NDIlib_video_frame_v2_t *p_video_data,
+                                    NDIlib_frame_format_type_e field_type)
+{
+  mockFramesync *sync = (mockFramesync *)p_instance;
+
+  // Keep the newest frame that has arrived, repeating it if nothing has
+  NDIlib_video_frame_v2_t next;
+  while (capture(sync->receiver, &next, nullptr, nullptr, 0) == NDIlib_frame_type_video)
+  {
+    if (sync->hasVideo)
+      freeVideo(sync->last);
+    sync->last = next;
+    sync->hasVideo = true;
+  }
+
+  if (!sync->hasVideo)
+  {
+    *p_video_data = NDIlib_video_frame_v2_t(0, 0);
+    return;
+  }
+  *p_video_data = copyVideo(sync->last);
+}
+
+void NDIlib_framesync_free_video(NDIlib_framesync_instance_t p_instance, NDIlib_video_frame_v2_t *p_video_data)
+{
+  if (p_video_data != nullptr && p_video_data->p_data != nullptr)
+    freeVideo(*p_video_data);
+}
+
+namespace
+{
+  // Moves any audio the receiver has into the frame sync's per-channel queues
+  void pullAudio(mockFramesync *sync)
+  {
+    NDIlib_audio_frame_v3_t audio;
+    while (capture(sync->receiver, nullptr, &audio, nullptr, 0) == NDIlib_frame_type_audio)
+    {
+      sync->sampleRate = audio.sample_rate;
+      if ((int)sync->audio.size() != audio.no_channels)
+        sync->audio.assign(audio.no_channels, std::deque<float>());
+      for (int c = 0; c < audio.no_channels; c++)
+      {
+        float *channel = (float *)(audio.p_data + c * audio.channel_stride_in_bytes);
+        sync->audio[c].insert(sync->audio[c].end(), channel, channel + audio.no_samples);
+      }
+      freeAudio(audio);
+    }
+  }
+} // namespace
+
+// No resampling: audio is returned at the source's rate, padded with silence
+void NDIlib_framesync_capture_audio_v2(NDIlib_framesync_instance_t p_instance,
+                                       NDIlib_audio_frame_v3_t *p_audio_data,
+                                       int sample_rate, int no_channels, int no_samples)
+{
+  mockFramesync *sync = (mockFramesync *)p_instance;
+  pullAudio(sync);
+
+  int available = sync->audio.empty() ? 0 : (int)sync->audio[0].size();
+  int channels = no_channels > 0 ? no_channels : (sync->audio.empty() ? config.channels : (int)sync->audio.size());
+  int samples = no_samples > 0 ? no_samples : available;
+
+  *p_audio_data = NDIlib_audio_frame_v3_t();
+  p_audio_data->sample_rate = sample_rate > 0 ? sample_rate : (sync->sampleRate > 0 ? sync->sampleRate : config.sampleRate);
+  p_audio_data->no_channels = channels;
+  p_audio_data->no_samples = samples;
+  p_audio_data->timecode = NDIlib_send_timecode_synthesize;
+  p_audio_data->FourCC = NDIlib_FourCC_audio_type_FLTP;
+  p_audio_data->channel_stride_in_bytes = samples * (int)sizeof(float);
+  p_audio_data->p_data = (uint8_t *)calloc((size_t)samples * channels + 1, sizeof(float));
+  p_audio_data->timestamp = wallTicks();
+
+  int taken = std::min(samples, available);
+  for (int c = 0; c < (int)sync->audio.size(); c++)
+  {
+    if (c < channels)
+    {
+      float *channel = (float *)(p_audio_data->p_data + c * p_audio_data->channel_stride_in_bytes);
+      std::copy(sync->audio[c].begin(), sync->audio[c].begin() + taken, channel);
+    }
+    sync->audio[c].erase(sync->audio[c].begin(), sync->audio[c].begin() + taken);
+  }
+}
+
+void NDIlib_framesync_free_audio_v2(NDIlib_framesync_instance_t p_instance, NDIlib_audio_frame_v3_t *p_audio_data)
+{
+  if (p_audio_data != nullptr)
+    free(p_audio_data->p_data);
+}
+
+int NDIlib_framesync_audio_queue_depth(NDIlib_framesync_instance_t p_instance)
+{
+  mockFramesync *sync = (mockFramesync *)p_instance;
+  pullAudio(sync);
+  return sync->audio.empty() ? 0 : (int)sync->audio[0].size();
+}
+
+/* Routing */
+
+NDIlib_routing_instance_t NDIlib_routing_create(const NDIlib_routing_create_t *p_create_settings)
+{
+  configure();
+  mockSource *source = registerSource(p_create_settings != nullptr ? p_create_settings->p_ndi_name : nullptr, true);
+  if (source == nullptr)
+    return nullptr;
+
+  mockRouter *router = new mockRouter;
+  router->source = source;
+  publish(source, router->published);
+  return (NDIlib_routing_instance_t)router;
+}
+
+void NDIlib_routing_destroy(NDIlib_routing_instance_t p_instance)
+{
+  mockRouter *router = (mockRouter *)p_instance;
+  if (router == nullptr)
+    return;
+  unregisterSource(router->source);
+  delete router;
+}
+
+bool NDIlib_routing_change(NDIlib_routing_instance_t p_instance, const NDIlib_source_t *p_source)
+{
+  mockRouter *router = (mockRouter *)p_instance;
+  std::lock_guard<std::mutex> guard(registry);
+  router->source->route = (p_source != nullptr && p_source->p_ndi_name != nullptr) ? p_source->p_ndi_name : "";
+  return true;
+}
+
+bool NDIlib_routing_clear(NDIlib_routing_instance_t p_instance)
+{
+  return NDIlib_routing_change(p_instance, nullptr);
+}
+
+int NDIlib_routing_get_no_connections(NDIlib_routing_instance_t p_instance, uint32_t timeout_in_ms)
+{
+  mockRouter *router = (mockRouter *)p_instance;
+  mockClock::time_point deadline = mockClock::now() + std::chrono::milliseconds(timeout_in_ms);
+  int connections = countConnections(router->source->name);
+  while (connections == 0 && mockClock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(MOCK_POLL));
+    connections = countConnections(router->source->name);
+  }
+  return connections;
+}
+
+const NDIlib_source_t *NDIlib_routing_get_source_name(NDIlib_routing_instance_t p_instance)
+{
+  return &((mockRouter *)p_instance)->published;
+}
+
+/* Utilities */
+
+void NDIlib_util_audio_to_interleaved_16s_v2(const NDIlib_audio_frame_v2_t *p_src, NDIlib_audio_frame_interleaved_16s_t *p_dst)
+{
+  p_dst->sample_rate = p_src->sample_rate;
+  p_dst->no_channels = p_src->no_channels;
+  p_dst->no_samples = p_src->no_samples;
+  p_dst->timecode = p_src->timecode;
+
+  // Full scale sits reference_level dB above a float sample of 1.0
+  float scale = 32767.0f * powf(10.0f, -p_dst->reference_level / 20.0f);
+  for (int c = 0; c < p_src->no_channels; c++)
+  {
+    const float *channel = (const float *)((const uint8_t *)p_src->p_data + c * p_src->channel_stride_in_bytes);
+    for (int s = 0; s < p_src->no_samples; s++)
+    {
+      float sample = std::max(-32768.0f, std::min(32767.0f, channel[s] * scale));
+      p_dst->p_data[s * p_src->no_channels + c] = (int16_t)sample;
+    }
+  }
+}
+
+void NDIlib_util_audio_to_interleaved_32f_v2(const NDIlib_audio_frame_v2_t *p_src, NDIlib_audio_frame_interleaved_32f_t *p_dst)
+{
+  p_dst->sample_rate = p_src->sample_rate;
+  p_dst->no_channels = p_src->no_channels;
+  p_dst->no_samples = p_src->no_samples;
+  p_dst->timecode = p_src->timecode;
+
+  for (int c = 0; c < p_src->no_channels; c++)
+  {
+    const float *channel = (const float *)((const uint8_t *)p_src->p_data + c * p_src->channel_stride_in_bytes);
+    for (int s = 0; s < p_src->no_samples; s++)
+      p_dst->p_data[s * p_src->no_channels + c] = channel[s];
+  }
+}
+
+/* Dynamic loading */
+
+// grandiose reaches the library through this table, so it is all that a
+// build of the mock as a loadable library needs to export
+const NDIlib_v5 *NDIlib_v5_load(void)
+{
+  static NDIlib_v5 table = []()
+  {
+    NDIlib_v5 t;
+    memset(&t, 0, sizeof(t));
+    t.initialize = NDIlib_initialize;
+    t.version = NDIlib_version;
+    t.is_supported_CPU = NDIlib_is_supported_CPU;
+    t.find_create_v2 = NDIlib_find_create2;
+    t.find_destroy = NDIlib_find_destroy;
+    t.find_get_current_sources = NDIlib_find_get_current_sources;
+    t.find_wait_for_sources = NDIlib_find_wait_for_sources;
+    t.send_create = NDIlib_send_create;
+    t.send_destroy = NDIlib_send_destroy;
+    t.send_send_video_v2 = NDIlib_send_send_video_v2;
+    t.send_send_video_async_v2 = NDIlib_send_send_video_async_v2;
+    t.send_send_audio_v3 = NDIlib_send_send_audio_v3;
+    t.send_send_metadata = NDIlib_send_send_metadata;
+    t.send_get_tally = NDIlib_send_get_tally;
+    t.send_get_no_connections = NDIlib_send_get_no_connections;
+    t.send_get_source_name = NDIlib_send_get_source_name;
+    t.recv_create_v3 = NDIlib_recv_create_v3;
+    t.recv_destroy = NDIlib_recv_destroy;
+    t.recv_connect = NDIlib_recv_connect;
+    t.recv_capture_v3 = NDIlib_recv_capture_v3;
+    t.recv_capture_v2 = NDIlib_recv_capture_v2;
+    t.recv_free_video_v2 = NDIlib_recv_free_video_v2;
+    t.recv_free_audio_v3 = NDIlib_recv_free_audio_v3;
+    t.recv_free_metadata = NDIlib_recv_free_metadata;
+    t.recv_get_performance = NDIlib_recv_get_performance;
+    t.recv_get_queue = NDIlib_recv_get_queue;
+    t.framesync_create = NDIlib_framesync_create;
+    t.framesync_destroy = NDIlib_framesync_destroy;
+    t.framesync_capture_video = NDIlib_framesync_capture_video;
+    t.framesync_free_video = NDIlib_framesync_free_video;
+    t.framesync_capture_audio_v2 = NDIlib_framesync_capture_audio_v2;
+    t.framesync_free_audio_v2 = NDIlib_framesync_free_audio_v2;
+    t.framesync_audio_queue_depth = NDIlib_framesync_audio_queue_depth;
+    t.routing_create = NDIlib_routing_create;
+    t.routing_destroy = NDIlib_routing_destroy;
+    t.routing_change = NDIlib_routing_change;
+    t.routing_clear = NDIlib_routing_clear;
+    t.routing_get_no_connections = NDIlib_routing_get_no_connections;
+    t.routing_get_source_name = NDIlib_routing_get_source_name;
+    t.util_audio_to_interleaved_16s_v2 = NDIlib_util_audio_to_interleaved_16s_v2;
+    t.util_audio_to_interleaved_32f_v2 = NDIlib_util_audio_to_interleaved_32f_v2;
+    return t;
+  }();
+  return &table;
+}
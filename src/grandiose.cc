@@ -14,55 +14,99 @@
 */
 
 #include <cstdio>
+#include <cstdlib>
 #include <chrono>
 #include <cstddef>
 #include <Processing.NDI.Lib.h>
 
-#ifdef _WIN32
-#ifdef _WIN64
-#pragma comment(lib, "Processing.NDI.Lib.x64.lib")
-#else // _WIN64
-#pragma comment(lib, "Processing.NDI.Lib.x86.lib")
-#endif // _WIN64
-#endif // _WIN32
-
 #include "grandiose_util.h"
 #include "grandiose_find.h"
 #include "grandiose_send.h"
 #include "grandiose_receive.h"
+#include "grandiose_framesync.h"
+#include "grandiose_receiver.h"
+#include "grandiose_relay.h"
+#include "grandiose_routing.h"
+#include "grandiose_executor.h"
+#include "grandiose_trace.h"
+#include "grandiose_log.h"
+#include "grandiose_metrics.h"
+#include "grandiose_ndi.h"
 #include "napi.h"
 
+// Both open the NDI library if needed, but neither initializes it
 Napi::Value version(const Napi::CallbackInfo &info)
 {
-  const char *ndiVersion = NDIlib_version();
-  return Napi::String::New(info.Env(), ndiVersion);
+  std::string error;
+  const NDIlib_v5 *lib = openNdi(error);
+  if (lib == nullptr)
+  {
+    Napi::Error::New(info.Env(), error).ThrowAsJavaScriptException();
+    return info.Env().Undefined();
+  }
+  return Napi::String::New(info.Env(), lib->version());
 }
 
 Napi::Value isSupportedCPU(const Napi::CallbackInfo &info)
 {
-  return Napi::Boolean::New(info.Env(), NDIlib_is_supported_CPU());
+  std::string error;
+  const NDIlib_v5 *lib = openNdi(error);
+  if (lib == nullptr)
+  {
+    Napi::Error::New(info.Env(), error).ThrowAsJavaScriptException();
+    return info.Env().Undefined();
+  }
+  return Napi::Boolean::New(info.Env(), lib->is_supported_CPU());
 }
 
-struct GrandioseInstanceData
+// Called once by index.js with the classes that wrap binary frame headers
+Napi::Value setFrameClasses(const Napi::CallbackInfo &info)
 {
-  std::unique_ptr<Napi::FunctionReference> finder;
-};
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsFunction() || !info[1].IsFunction())
+  {
+    Napi::TypeError::New(env, "Expected video and audio frame classes").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  GrandioseInstanceData *instance = env.GetInstanceData<GrandioseInstanceData>();
+  instance->videoFrame = Napi::Persistent(info[0].As<Napi::Function>());
+  instance->audioFrame = Napi::Persistent(info[1].As<Napi::Function>());
+  return env.Undefined();
+}
 
 Napi::Object Init(Napi::Env env, Napi::Object exports)
 {
+  // The NDI library is not opened until something needs it, see grandiose_ndi.h
+
+  // Size the executor like the libuv thread pool, from the environment
+  const char *threads = getenv("GRANDIOSE_THREADPOOL_SIZE");
+  if (threads != nullptr && atoi(threads) > 0)
+    configureExecutor((uint32_t)atoi(threads));
 
-  // Not required, but "correct" (see the SDK documentation).
-  if (!NDIlib_initialize()) // TODO - throw in a way that users can catch
-    return exports;
+  const char *level = getenv("GRANDIOSE_LOG_LEVEL");
+  if (level != nullptr && !setLogLevelName(level))
+    LOG_WARN("Unknown GRANDIOSE_LOG_LEVEL '%s', expected off, error, warn, info or debug.", level);
 
   napi_status status;
   napi_property_descriptor desc[] = {
       DECLARE_NAPI_METHOD("send", send),
-      DECLARE_NAPI_METHOD("receive", receive)};
-  status = napi_define_properties(env, exports, 2, desc);
+      DECLARE_NAPI_METHOD("receive", receive),
+      DECLARE_NAPI_METHOD("routing", routing),
+      DECLARE_NAPI_METHOD("routingSalvo", routingSalvo),
+      DECLARE_NAPI_METHOD("executorStats", executorStatistics),
+      DECLARE_NAPI_METHOD("traceStart", traceStart),
+      DECLARE_NAPI_METHOD("traceStop", traceStop),
+      DECLARE_NAPI_METHOD("traceDump", traceDump),
+      DECLARE_NAPI_METHOD("setLogLevel", setLogLevel),
+      DECLARE_NAPI_METHOD("setLogCallback", setLogCallback),
+      DECLARE_NAPI_METHOD("metrics", metricsText),
+      DECLARE_NAPI_METHOD("setLibraryPath", setLibraryPath)};
+  status = napi_define_properties(env, exports, 12, desc);
 
   exports.Set("version", Napi::Function::New(env, version));
   exports.Set("isSupportedCPU", Napi::Function::New(env, isSupportedCPU));
+  exports.Set("setFrameClasses", Napi::Function::New(env, setFrameClasses));
 
   auto finderRef = GrandioseFinder::Initialize(env, exports);
 
@@ -72,6 +116,11 @@ Napi::Object Init(Napi::Env env, Napi::Object exports)
   // contexts on the same thread.
   env.SetInstanceData<GrandioseInstanceData>(new GrandioseInstanceData{
       std::move(finderRef),
+      createExecutorDispatcher(env),
+      GrandioseFrameSync::Initialize(env),
+      GrandioseReceiver::Initialize(env),
+      GrandioseRelay::Initialize(env),
+      GrandioseRouting::Initialize(env),
   });
 
   return exports;
@@ -0,0 +1,263 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "grandiose_executor.h"
+#include "grandiose_util.h"
+#include "grandiose_trace.h"
+
+// Completions for one environment are funnelled through a single thread-safe
+// function, which is only referenced while work is outstanding so that an idle
+// executor does not keep the event loop alive. The dispatcher is counted by
+// the environment and by each work item in flight, so that executor threads
+// can find out that the thread-safe function has been finalized.
+struct executorDispatcher {
+  napi_threadsafe_function tsfn = nullptr;
+  uint32_t pending = 0; // only touched on the JavaScript thread
+  std::mutex lock;
+  bool closed = false; // tsfn has been finalized
+  std::atomic<uint32_t> refCount{1};
+};
+
+static void releaseDispatcher(executorDispatcher *dispatcher)
+{
+  if (dispatcher->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete dispatcher;
+}
+
+// Work whose environment has gone cannot complete
+static void abandonWork(executorWork *work)
+{
+  LOG_DEBUG("Executor work abandoned as its environment was torn down.");
+  delete work->owner;
+}
+
+// The pool is shared by all environments in the process and is never torn
+// down, as its threads may be blocked inside NDI calls at exit. Work is queued
+// through its own next pointer, so queueing never allocates.
+struct executorPool {
+  std::mutex lock;
+  std::condition_variable wake;
+  executorWork *head = nullptr;
+  executorWork *tail = nullptr;
+  uint32_t queued = 0;
+  std::vector<std::thread> threads;
+  uint32_t size = GRANDIOSE_EXECUTOR_DEFAULT_THREADS;
+  std::atomic<uint32_t> busy{0};
+  std::atomic<uint64_t> completed{0};
+  std::atomic<uint64_t> busyTime{0};
+};
+
+static executorPool *pool = new executorPool;
+
+static void executorRun()
+{
+  traceThreadName("grandiose executor");
+  for (;;)
+  {
+    executorWork *work;
+    {
+      std::unique_lock<std::mutex> guard(pool->lock);
+      pool->wake.wait(guard, []
+                      { return pool->head != nullptr; });
+      work = pool->head;
+      pool->head = work->next;
+      if (pool->head == nullptr)
+        pool->tail = nullptr;
+      pool->queued--;
+      work->next = nullptr;
+    }
+
+    pool->busy++;
+    HR_TIME_POINT start = NOW;
+    work->execute(work->env, work->data);
+    pool->busyTime.fetch_add(microTime(start), std::memory_order_relaxed);
+    pool->busy--;
+    pool->completed.fetch_add(1, std::memory_order_relaxed);
+
+    // Work may be completed and freed as soon as it is passed on
+    executorDispatcher *dispatcher = work->dispatcher;
+    napi_status status = napi_closing;
+    {
+      std::lock_guard<std::mutex> guard(dispatcher->lock);
+      if (!dispatcher->closed)
+        status = napi_call_threadsafe_function(dispatcher->tsfn, work, napi_tsfn_nonblocking);
+    }
+    if (status != napi_ok)
+    {
+      if (status != napi_closing)
+        LOG_ERROR("Executor could not complete work, status %i.", status);
+      abandonWork(work);
+    }
+    releaseDispatcher(dispatcher);
+  }
+}
+
+// Must be called with the pool lock held
+static void startThreads()
+{
+  while (pool->threads.size() < pool->size)
+    pool->threads.emplace_back(executorRun);
+}
+
+static void executorComplete(napi_env env, napi_value jsCallback, void *context, void *data)
+{
+  executorDispatcher *dispatcher = (executorDispatcher *)context;
+  executorWork *work = (executorWork *)data;
+  if (env == nullptr) // environment is shutting down
+  {
+    abandonWork(work);
+    return;
+  }
+
+  if (--dispatcher->pending == 0)
+    napi_unref_threadsafe_function(env, dispatcher->tsfn);
+
+  work->complete(env, napi_ok, work->data);
+}
+
+static void finalizeDispatcher(napi_env env, void *data, void *hint)
+{
+  executorDispatcher *dispatcher = (executorDispatcher *)data;
+  {
+    std::lock_guard<std::mutex> guard(dispatcher->lock);
+    dispatcher->closed = true;
+  }
+  releaseDispatcher(dispatcher);
+}
+
+executorDispatcher *createExecutorDispatcher(napi_env env)
+{
+  napi_status status;
+  executorDispatcher *dispatcher = new executorDispatcher;
+
+  napi_value resourceName;
+  status = napi_create_string_utf8(env, "GrandioseExecutor", NAPI_AUTO_LENGTH, &resourceName);
+  if (status == napi_ok)
+    status = napi_create_threadsafe_function(env, nullptr, nullptr, resourceName, 0, 1,
+                                             dispatcher, finalizeDispatcher, dispatcher,
+                                             executorComplete, &dispatcher->tsfn);
+  if (status != napi_ok)
+  {
+    delete dispatcher;
+    return nullptr;
+  }
+
+  napi_unref_threadsafe_function(env, dispatcher->tsfn);
+  return dispatcher;
+}
+
+void configureExecutor(uint32_t threads)
+{
+  std::lock_guard<std::mutex> guard(pool->lock);
+  if (threads > pool->size || pool->threads.empty())
+    pool->size = threads;
+  if (!pool->threads.empty())
+    startThreads();
+}
+
+napi_status queueWork(napi_env env, carrier *c,
+                      napi_async_execute_callback execute, napi_async_complete_callback complete, void *data)
+{
+  executorWork *work = &c->_work;
+  napi_status status;
+  GrandioseInstanceData *instance;
+  status = napi_get_instance_data(env, (void **)&instance);
+  PASS_STATUS;
+  if (instance == nullptr || instance->executor == nullptr)
+    return napi_generic_failure;
+
+  work->env = env;
+  work->execute = execute;
+  work->complete = complete;
+  work->data = data;
+  work->dispatcher = instance->executor;
+  work->owner = c;
+
+  if (work->dispatcher->pending++ == 0)
+  {
+    status = napi_ref_threadsafe_function(env, work->dispatcher->tsfn);
+    PASS_STATUS;
+  }
+  work->dispatcher->refCount.fetch_add(1, std::memory_order_relaxed);
+
+  {
+    std::lock_guard<std::mutex> guard(pool->lock);
+    startThreads();
+    work->next = nullptr;
+    if (pool->tail != nullptr)
+      pool->tail->next = work;
+    else
+      pool->head = work;
+    pool->tail = work;
+    pool->queued++;
+  }
+  pool->wake.notify_one();
+
+  return napi_ok;
+}
+
+executorStats getExecutorStats()
+{
+  std::lock_guard<std::mutex> guard(pool->lock);
+  return executorStats{
+      (uint32_t)pool->threads.size(),
+      pool->busy.load(),
+      pool->queued,
+      pool->completed.load(std::memory_order_relaxed),
+      pool->busyTime.load(std::memory_order_relaxed)};
+}
+
+napi_value executorStatistics(napi_env env, napi_callback_info info)
+{
+  napi_status status;
+  executorStats stats = getExecutorStats();
+
+  napi_value result, value;
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+
+  status = napi_create_uint32(env, stats.threads, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "threads", value);
+  CHECK_STATUS;
+
+  status = napi_create_uint32(env, stats.busy, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "busy", value);
+  CHECK_STATUS;
+
+  status = napi_create_uint32(env, stats.queued, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "queued", value);
+  CHECK_STATUS;
+
+  status = napi_create_double(env, (double)stats.completed, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "completed", value);
+  CHECK_STATUS;
+
+  status = napi_create_double(env, (double)stats.busyTime, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "busyTime", value);
+  CHECK_STATUS;
+
+  return result;
+}
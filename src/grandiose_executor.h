@@ -0,0 +1,69 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_EXECUTOR_H
+#define GRANDIOSE_EXECUTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include "node_api.h"
+
+// Blocking NDI calls run on grandiose's own pool of threads rather than the
+// libuv thread pool, so that receivers waiting on frames cannot starve file
+// system, DNS or crypto work, nor each other. Work follows the same execute /
+// complete pattern as napi_create_async_work, with the complete callback run
+// on the JavaScript thread of the environment that queued it.
+
+#define GRANDIOSE_EXECUTOR_DEFAULT_THREADS 16
+
+struct carrier;
+struct executorDispatcher;
+
+struct executorWork {
+  napi_env env = nullptr;
+  napi_async_execute_callback execute = nullptr;
+  napi_async_complete_callback complete = nullptr;
+  void* data = nullptr;
+  executorDispatcher* dispatcher = nullptr;
+  carrier* owner = nullptr; // deleted if its environment goes before it completes
+  executorWork* next = nullptr; // while queued
+};
+
+struct executorStats {
+  uint32_t threads;
+  uint32_t busy;
+  uint32_t queued;
+  uint64_t completed;
+  uint64_t busyTime; // microseconds spent running work, across all threads
+};
+
+// Set up completion dispatch for an environment. Called once from Init.
+executorDispatcher* createExecutorDispatcher(napi_env env);
+
+// Set the number of executor threads. The pool can only grow once started.
+void configureExecutor(uint32_t threads);
+
+// Queue the work of a carrier on the executor. The carrier must stay valid
+// until complete is called. If the environment is torn down first, complete
+// is never called and the carrier is deleted instead, on whichever thread
+// finds out.
+napi_status queueWork(napi_env env, carrier* c,
+  napi_async_execute_callback execute, napi_async_complete_callback complete, void* data);
+
+executorStats getExecutorStats();
+
+napi_value executorStatistics(napi_env env, napi_callback_info info);
+
+#endif /* GRANDIOSE_EXECUTOR_H */
@@ -14,18 +14,13 @@
 */
 
 #include <cstddef>
+#include <unordered_map>
 #include <Processing.NDI.Lib.h>
 
-#ifdef _WIN32
-#ifdef _WIN64
-#pragma comment(lib, "Processing.NDI.Lib.x64.lib")
-#else // _WIN64
-#pragma comment(lib, "Processing.NDI.Lib.x86.lib")
-#endif // _WIN64
-#endif // _WIN32
-
 #include "grandiose_util.h"
 #include "grandiose_find.h"
+#include "grandiose_trace.h"
+#include "grandiose_metrics.h"
 #include "util.h"
 
 std::unique_ptr<Napi::FunctionReference> GrandioseFinder::Initialize(const Napi::Env &env, Napi::Object exports)
@@ -36,6 +31,9 @@ std::unique_ptr<Napi::FunctionReference> GrandioseFinder::Initialize(const Napi:
                                                                 InstanceMethod<&GrandioseFinder::Dispose>("dispose", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
 
                                                                 InstanceMethod<&GrandioseFinder::GetSources>("getCurrentSources", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                StaticMethod<&GrandioseFinder::Create>("create", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+
+                                                                InstanceMethod<&GrandioseFinder::Watch>("watch", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
 
                                                             });
 
@@ -47,57 +45,103 @@ std::unique_ptr<Napi::FunctionReference> GrandioseFinder::Initialize(const Napi:
   return constructor;
 }
 
-GrandioseFinder::GrandioseFinder(const Napi::CallbackInfo &info) : Napi::ObjectWrap<GrandioseFinder>(info)
+// Throws and returns false if the options are not valid
+bool parseFinderOptions(const Napi::Env &env, const Napi::Value &value, GrandioseFinderOptions &options)
 {
-  if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsNull())
+  if (value.IsUndefined() || value.IsNull())
+    return true;
+
+  if (!value.IsObject())
   {
-    if (!info[0].IsObject())
-    {
-      Napi::Error::New(info.Env(), "Expected an options object").ThrowAsJavaScriptException();
-      return;
-    }
-    Napi::Object rawOptions = info[0].As<Napi::Object>();
+    Napi::Error::New(env, "Expected an options object").ThrowAsJavaScriptException();
+    return false;
+  }
+  Napi::Object rawOptions = value.As<Napi::Object>();
 
-    bool rawShowLocalSources = false;
-    if (parseBoolean(info.Env(), rawOptions.Get("showLocalSources"), rawShowLocalSources))
-    {
-      options.showLocalSources = rawShowLocalSources;
-    }
-    else
-    {
-      Napi::Error::New(info.Env(), "options.showLocalSources must be a boolean").ThrowAsJavaScriptException();
-      return;
-    }
+  bool rawShowLocalSources = false;
+  if (parseBoolean(env, rawOptions.Get("showLocalSources"), rawShowLocalSources))
+  {
+    options.showLocalSources = rawShowLocalSources;
+  }
+  else
+  {
+    Napi::Error::New(env, "options.showLocalSources must be a boolean").ThrowAsJavaScriptException();
+    return false;
+  }
 
-    std::string rawGroups = "";
-    if (parseString(info.Env(), rawOptions.Get("groups"), rawGroups))
-    {
-      options.groups = rawGroups;
-    }
-    else
-    {
-      Napi::Error::New(info.Env(), "options.groups must be an array of strings").ThrowAsJavaScriptException();
-      return;
-    }
+  std::string rawGroups = "";
+  if (parseString(env, rawOptions.Get("groups"), rawGroups))
+  {
+    options.groups = rawGroups;
+  }
+  else
+  {
+    Napi::Error::New(env, "options.groups must be an array of strings").ThrowAsJavaScriptException();
+    return false;
+  }
 
-    std::string rawExtraIps = "";
-    if (parseString(info.Env(), rawOptions.Get("extraIPs"), rawExtraIps))
-    {
-      options.extraIPs = rawExtraIps;
-    }
-    else
-    {
-      Napi::Error::New(info.Env(), "options.extraIPs must be an array of strings").ThrowAsJavaScriptException();
-      return;
-    }
+  std::string rawExtraIps = "";
+  if (parseString(env, rawOptions.Get("extraIPs"), rawExtraIps))
+  {
+    options.extraIPs = rawExtraIps;
+  }
+  else
+  {
+    Napi::Error::New(env, "options.extraIPs must be an array of strings").ThrowAsJavaScriptException();
+    return false;
   }
 
+  if (!parseOptionalUint32(env, rawOptions.Get("minSources"), options.minSources) ||
+      !parseOptionalUint32(env, rawOptions.Get("timeout"), options.timeout))
+  {
+    Napi::Error::New(env, "options.minSources and options.timeout must be numbers").ThrowAsJavaScriptException();
+    return false;
+  }
+
+  return true;
+}
+
+NDIlib_find_instance_t createFinder(const GrandioseFinderOptions &options)
+{
   NDIlib_find_create_t find_create;
   find_create.show_local_sources = options.showLocalSources;
   find_create.p_groups = options.groups.length() > 0 ? options.groups.c_str() : nullptr;
   find_create.p_extra_ips = options.extraIPs.length() > 0 ? options.extraIPs.c_str() : nullptr;
 
-  handle = NDIlib_find_create2(&find_create);
+  NDIlib_find_instance_t handle = ndiLib->find_create_v2(&find_create);
+  if (handle)
+    metrics.finders.fetch_add(1, std::memory_order_relaxed);
+  return handle;
+}
+
+void destroyFinder(NDIlib_find_instance_t handle)
+{
+  ndiLib->find_destroy(handle);
+  metrics.finders.fetch_sub(1, std::memory_order_relaxed);
+}
+
+GrandioseFinder::GrandioseFinder(const Napi::CallbackInfo &info) : Napi::ObjectWrap<GrandioseFinder>(info)
+{
+  // Finders made by GrandioseFinder.create() arrive already created
+  if (info.Length() > 0 && info[0].IsExternal())
+  {
+    handle = (NDIlib_find_instance_t)internalState(info);
+    if (handle == nullptr)
+      Napi::TypeError::New(info.Env(), "Expected finder options").ThrowAsJavaScriptException();
+    return;
+  }
+
+  std::string error;
+  if (!loadNdi(error))
+  {
+    Napi::Error::New(info.Env(), error).ThrowAsJavaScriptException();
+    return;
+  }
+
+  if (info.Length() > 0 && !parseFinderOptions(info.Env(), info[0], options))
+    return;
+
+  handle = createFinder(options);
   if (!handle)
   {
     Napi::Error::New(info.Env(), "Failed to initialize NDI finder").ThrowAsJavaScriptException();
@@ -112,9 +156,10 @@ GrandioseFinder::~GrandioseFinder()
 
 void GrandioseFinder::cleanup()
 {
+  stopWatching();
   if (handle != nullptr)
   {
-    NDIlib_find_destroy(handle);
+    destroyFinder(handle);
     handle = nullptr;
   }
 }
@@ -128,6 +173,7 @@ Napi::Value GrandioseFinder::Dispose(const Napi::CallbackInfo &info)
 
 Napi::Value GrandioseFinder::GetSources(const Napi::CallbackInfo &info)
 {
+  traceScope span(TRACE_FIND, "getCurrentSources");
   Napi::Env env = info.Env();
 
   if (!handle)
@@ -136,8 +182,20 @@ Napi::Value GrandioseFinder::GetSources(const Napi::CallbackInfo &info)
     return env.Null();
   }
 
+  if (watching)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    Napi::Array result = Napi::Array::New(env, known.size());
+    for (size_t i = 0; i < known.size(); i++)
+    {
+      NDIlib_source_t source(known[i].name.c_str(), known[i].urlAddress.c_str());
+      result[i] = convertSourceToNapi(env, source);
+    }
+    return result;
+  }
+
   uint32_t count = 0;
-  const NDIlib_source_t *sources = NDIlib_find_get_current_sources(handle, &count);
+  const NDIlib_source_t *sources = ndiLib->find_get_current_sources(handle, &count);
 
   if (!sources || count == 0)
     return Napi::Array::New(env, 0);
@@ -151,3 +209,225 @@ Napi::Value GrandioseFinder::GetSources(const Napi::CallbackInfo &info)
 
   return result;
 }
+
+// Start a thread that waits for the sources on the network to change, calling
+// back with only the sources added and removed since it last looked
+Napi::Value GrandioseFinder::Watch(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  if (!handle)
+  {
+    Napi::Error::New(env, "GrandioseFinder has been disposed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() < 1 || !info[0].IsFunction())
+  {
+    Napi::TypeError::New(env, "Expected a callback function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (watching)
+  {
+    Napi::Error::New(env, "GrandioseFinder is already watching").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  tsfn = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "GrandioseFinder", 0, 1);
+  if (env.IsExceptionPending())
+    return env.Null();
+  // Watching alone does not keep the process alive
+  tsfn.Unref(env);
+
+  watching = true;
+  watcher = std::thread(&GrandioseFinder::watchSources, this);
+
+  return env.Undefined();
+}
+
+void GrandioseFinder::stopWatching()
+{
+  if (!watching)
+    return;
+
+  watching = false;
+  if (watcher.joinable())
+    watcher.join();
+  // Changes still queued for delivery are dropped
+  tsfn.Release();
+}
+
+void GrandioseFinder::watchSources()
+{
+  traceThreadName("grandiose finder");
+  std::unordered_map<std::string, std::string> previous;
+  // Look once straight away, as sources found before watching started do not
+  // count as a change
+  bool look = true;
+  while (watching)
+  {
+    if (!look && !ndiLib->find_wait_for_sources(handle, 100))
+      continue;
+    look = false;
+    traceScope span(TRACE_FIND, "watchSources");
+
+    uint32_t count = 0;
+    const NDIlib_source_t *sources = ndiLib->find_get_current_sources(handle, &count);
+
+    std::vector<finderSource> current;
+    std::unordered_map<std::string, std::string> currentByName;
+    finderChanges *changes = new finderChanges;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      finderSource source{sources[i].p_ndi_name ? sources[i].p_ndi_name : "",
+                          sources[i].p_url_address ? sources[i].p_url_address : ""};
+      auto found = previous.find(source.name);
+      if (found == previous.end())
+      {
+        changes->added.push_back(source);
+      }
+      else if (found->second != source.urlAddress)
+      {
+        // A source that has moved is reported as going away and coming back
+        changes->removed.push_back({found->first, found->second});
+        changes->added.push_back(source);
+      }
+      currentByName[source.name] = source.urlAddress;
+      current.push_back(std::move(source));
+    }
+    for (const auto &entry : previous)
+    {
+      if (currentByName.find(entry.first) == currentByName.end())
+        changes->removed.push_back({entry.first, entry.second});
+    }
+    previous = std::move(currentByName);
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      known = std::move(current);
+    }
+
+    if ((changes->added.empty() && changes->removed.empty()) ||
+        tsfn.BlockingCall(changes, deliverChanges) != napi_ok)
+      delete changes;
+  }
+}
+
+void GrandioseFinder::deliverChanges(Napi::Env env, Napi::Function callback, finderChanges *changes)
+{
+  traceScope span(TRACE_FIND, "deliverChanges");
+  // Called without an environment when the finder is being torn down
+  if (env != nullptr && callback != nullptr)
+  {
+    Napi::Array added = Napi::Array::New(env, changes->added.size());
+    for (size_t i = 0; i < changes->added.size(); i++)
+    {
+      NDIlib_source_t source(changes->added[i].name.c_str(), changes->added[i].urlAddress.c_str());
+      added[i] = convertSourceToNapi(env, source);
+    }
+    Napi::Array removed = Napi::Array::New(env, changes->removed.size());
+    for (size_t i = 0; i < changes->removed.size(); i++)
+    {
+      NDIlib_source_t source(changes->removed[i].name.c_str(), changes->removed[i].urlAddress.c_str());
+      removed[i] = convertSourceToNapi(env, source);
+    }
+    callback.Call({added, removed});
+  }
+  delete changes;
+}
+
+void finderCreateExecute(napi_env env, void *data)
+{
+  finderCarrier *c = (finderCarrier *)data;
+  traceScope span(TRACE_FIND, "finderCreateExecute");
+
+  c->handle = createFinder(c->options);
+  if (!c->handle)
+  {
+    c->status = GRANDIOSE_FIND_CREATE_FAIL;
+    c->errorMsg = "Failed to initialize NDI finder";
+    return;
+  }
+
+  // Resolve early once enough sources are known, or at the timeout regardless
+  HR_TIME_POINT start = NOW;
+  long long timeout = (long long)c->options.timeout * 1000;
+  uint32_t count = 0;
+  ndiLib->find_get_current_sources(c->handle, &count);
+  while (count < c->options.minSources && microTime(start) < timeout)
+  {
+    uint32_t remaining = (uint32_t)((timeout - microTime(start)) / 1000);
+    if (ndiLib->find_wait_for_sources(c->handle, remaining))
+      ndiLib->find_get_current_sources(c->handle, &count);
+  }
+}
+
+void finderCreateComplete(napi_env env, napi_status asyncStatus, void *data)
+{
+  finderCarrier *c = (finderCarrier *)data;
+
+  if (asyncStatus != napi_ok)
+  {
+    c->status = asyncStatus;
+    c->errorMsg = "Async finder creation failed to complete.";
+  }
+  REJECT_STATUS;
+
+  Napi::Env napiEnv(env);
+  GrandioseInstanceData *instance = napiEnv.GetInstanceData<GrandioseInstanceData>();
+  Napi::Object finder;
+  if (!newInternal(*instance->finder, c->handle).UnwrapTo(&finder))
+  {
+    napi_value error;
+    napi_get_and_clear_last_exception(env, &error);
+    napi_reject_deferred(env, c->_deferred, error);
+    tidyCarrier(env, c);
+    return;
+  }
+  // The finder object owns the handle now
+  c->handle = nullptr;
+
+  napi_status status;
+  status = napi_resolve_deferred(env, c->_deferred, finder);
+  FLOATING_STATUS;
+
+  tidyCarrier(env, c);
+}
+
+// GrandioseFinder.create(options), which creates the finder and waits for
+// sources on an executor thread rather than the JavaScript thread
+napi_value finderCreate(napi_env env, napi_callback_info info)
+{
+  finderCarrier *c = new finderCarrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+
+  std::string error;
+  if (!loadNdi(error))
+    REJECT_ERROR_RETURN(error, GRANDIOSE_NDI_LOAD_FAIL);
+
+  size_t argc = 1;
+  napi_value args[1];
+  c->status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  REJECT_RETURN;
+
+  if (argc >= 1 && !parseFinderOptions(Napi::Env(env), Napi::Value(env, args[0]), c->options))
+  {
+    napi_value error;
+    napi_get_and_clear_last_exception(env, &error);
+    napi_reject_deferred(env, c->_deferred, error);
+    tidyCarrier(env, c);
+    return promise;
+  }
+
+  c->status = queueWork(env, c, finderCreateExecute, finderCreateComplete, c);
+  REJECT_RETURN;
+
+  return promise;
+}
+
+Napi::Value GrandioseFinder::Create(const Napi::CallbackInfo &info)
+{
+  return Napi::Value(info.Env(), finderCreate(info.Env(), info));
+}
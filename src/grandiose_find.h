@@ -15,6 +15,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "napi.h"
 #include "grandiose_util.h"
 #include <cstddef>
@@ -22,11 +26,46 @@
 
 struct GrandioseFinderOptions
 {
-  bool showLocalSources;
+  bool showLocalSources = false;
   std::string groups;
   std::string extraIPs;
+  // Only for GrandioseFinder.create(), which waits for this many sources or
+  // until the timeout in milliseconds passes
+  uint32_t minSources = 0;
+  uint32_t timeout = 0;
 };
 
+// Destroys a finder made by createFinder(), counting it out of the metrics
+void destroyFinder(NDIlib_find_instance_t handle);
+
+struct finderCarrier : carrier
+{
+  GrandioseFinderOptions options;
+  NDIlib_find_instance_t handle = nullptr;
+  ~finderCarrier()
+  {
+    // Only left set if the finder object was never made
+    if (handle != nullptr)
+      destroyFinder(handle);
+  }
+};
+
+struct finderSource
+{
+  std::string name;
+  std::string urlAddress;
+};
+
+// Sources that appeared or went away between two looks at the network
+struct finderChanges
+{
+  std::vector<finderSource> added;
+  std::vector<finderSource> removed;
+};
+
+bool parseFinderOptions(const Napi::Env &env, const Napi::Value &value, GrandioseFinderOptions &options);
+NDIlib_find_instance_t createFinder(const GrandioseFinderOptions &options);
+
 class GrandioseFinder : public Napi::ObjectWrap<GrandioseFinder>
 {
 public:
@@ -36,13 +75,27 @@ public:
   ~GrandioseFinder();
 
 private:
+  static Napi::Value Create(const Napi::CallbackInfo &info);
+
   // Napi::Value GetProperties(const Napi::CallbackInfo &info);
   Napi::Value Dispose(const Napi::CallbackInfo &info);
 
   Napi::Value GetSources(const Napi::CallbackInfo &info);
+  Napi::Value Watch(const Napi::CallbackInfo &info);
 
   void cleanup();
+  void stopWatching();
+  void watchSources();
+  static void deliverChanges(Napi::Env env, Napi::Function callback, finderChanges *changes);
 
   NDIlib_find_instance_t handle = nullptr;
   GrandioseFinderOptions options;
+
+  // While watching, only the watcher thread asks NDI for sources, as that
+  // invalidates the previous list. Others read the copy kept here.
+  std::thread watcher;
+  std::atomic<bool> watching{false};
+  Napi::ThreadSafeFunction tsfn;
+  std::mutex lock;
+  std::vector<finderSource> known;
 };
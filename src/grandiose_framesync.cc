@@ -0,0 +1,267 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <Processing.NDI.Lib.h>
+
+#include "grandiose_util.h"
+#include "grandiose_receive.h"
+#include "grandiose_framesync.h"
+#include "util.h"
+
+std::unique_ptr<Napi::FunctionReference> GrandioseFrameSync::Initialize(const Napi::Env &env)
+{
+  Napi::HandleScope scope(env);
+
+  Napi::Function func = DefineClass(env, "GrandioseFrameSync", {
+                                                                   InstanceMethod<&GrandioseFrameSync::Destroy>("destroy", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+
+                                                                   InstanceMethod<&GrandioseFrameSync::Video>("video", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                   InstanceMethod<&GrandioseFrameSync::Audio>("audio", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                   InstanceMethod<&GrandioseFrameSync::AudioQueueDepth>("audioQueueDepth", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+
+                                                               });
+
+  // Only created through receiver.frameSync(), so the class is not exported
+  std::unique_ptr<Napi::FunctionReference> constructor = std::make_unique<Napi::FunctionReference>();
+  *constructor = Napi::Persistent(func);
+
+  return constructor;
+}
+
+GrandioseFrameSync::GrandioseFrameSync(const Napi::CallbackInfo &info) : Napi::ObjectWrap<GrandioseFrameSync>(info)
+{
+  receiverState *state = (receiverState *)internalState(info);
+  if (state == nullptr)
+  {
+    Napi::TypeError::New(info.Env(), "Frame syncs are created with receiver.frameSync()").ThrowAsJavaScriptException();
+    return;
+  }
+
+  handle = ndiLib->framesync_create(state->recv);
+  if (!handle)
+  {
+    Napi::Error::New(info.Env(), "Failed to create NDI frame sync").ThrowAsJavaScriptException();
+    return;
+  }
+  receiver = retainReceiver(state);
+}
+
+GrandioseFrameSync::~GrandioseFrameSync()
+{
+  cleanup();
+}
+
+void GrandioseFrameSync::cleanup()
+{
+  if (handle != nullptr)
+  {
+    ndiLib->framesync_destroy(handle);
+    handle = nullptr;
+  }
+  if (receiver != nullptr)
+  {
+    releaseReceiver(receiver);
+    receiver = nullptr;
+  }
+}
+
+Napi::Value GrandioseFrameSync::Destroy(const Napi::CallbackInfo &info)
+{
+  cleanup();
+
+  return info.Env().Null();
+}
+
+Napi::Value GrandioseFrameSync::Video(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  if (!handle)
+  {
+    Napi::Error::New(env, "GrandioseFrameSync has been destroyed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  NDIlib_frame_format_type_e frameFormat = NDIlib_frame_format_type_progressive;
+  if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsNull())
+  {
+    if (!info[0].IsObject())
+    {
+      Napi::TypeError::New(env, "Expected an options object").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    uint32_t rawFrameFormat = frameFormat;
+    if (!parseOptionalUint32(env, info[0].As<Napi::Object>().Get("frameFormat"), rawFrameFormat) ||
+        !validFrameFormat((NDIlib_frame_format_type_e)rawFrameFormat))
+    {
+      Napi::TypeError::New(env, "Invalid frame format type specified.").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    frameFormat = (NDIlib_frame_format_type_e)rawFrameFormat;
+  }
+
+  NDIlib_video_frame_v2_t frame;
+  ndiLib->framesync_capture_video(handle, &frame, frameFormat);
+  if (frame.p_data == nullptr)
+  {
+    // Nothing has been received yet
+    ndiLib->framesync_free_video(handle, &frame);
+    return env.Null();
+  }
+
+  napi_value result;
+  napi_status status = videoFramePropertiesToJs(env, frame, &result);
+  if (status == napi_ok)
+  {
+    size_t length = (size_t)frame.line_stride_in_bytes * frame.yres;
+    Napi::Object(env, result).Set("data", Napi::Buffer<uint8_t>::Copy(env, frame.p_data, length));
+  }
+  ndiLib->framesync_free_video(handle, &frame);
+
+  if (status != napi_ok)
+  {
+    checkStatus(env, status, __FILE__, __LINE__);
+    return env.Null();
+  }
+  return Napi::Value(env, result);
+}
+
+Napi::Value GrandioseFrameSync::Audio(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  if (!handle)
+  {
+    Napi::Error::New(env, "GrandioseFrameSync has been destroyed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (info.Length() < 1 || !info[0].IsObject())
+  {
+    Napi::TypeError::New(env, "Expected an options object with the number of samples").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object rawOptions = info[0].As<Napi::Object>();
+
+  // Zero sample rate or channels means use those of the incoming audio
+  uint32_t sampleRate = 0, channels = 0, samples = 0;
+  if (!parseOptionalUint32(env, rawOptions.Get("sampleRate"), sampleRate) ||
+      !parseOptionalUint32(env, rawOptions.Get("channels"), channels) ||
+      !parseOptionalUint32(env, rawOptions.Get("samples"), samples) || samples == 0)
+  {
+    Napi::TypeError::New(env, "options.samples must be a positive number, options.sampleRate and options.channels numbers").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  uint32_t audioFormat = Grandiose_audio_format_float_32_separate;
+  if (!parseOptionalUint32(env, rawOptions.Get("audioFormat"), audioFormat) ||
+      !validAudioFormat((Grandiose_audio_format_e)audioFormat))
+  {
+    Napi::TypeError::New(env, "Invalid audio format specified.").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  uint32_t referenceLevel = 20;
+  if (!parseOptionalUint32(env, rawOptions.Get("referenceLevel"), referenceLevel))
+  {
+    Napi::TypeError::New(env, "options.referenceLevel must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  NDIlib_audio_frame_v3_t captured;
+  ndiLib->framesync_capture_audio_v2(handle, &captured, sampleRate, channels, samples);
+
+  // Frame syncs always deliver planar float
+  NDIlib_audio_frame_v2_t frame = planarAudioView(captured);
+
+  napi_value result;
+  napi_status status = audioFramePropertiesToJs(env, captured, (Grandiose_audio_format_e)audioFormat,
+                                                (int32_t)referenceLevel, &result);
+  if (status == napi_ok)
+  {
+    size_t count = (size_t)frame.no_samples * frame.no_channels;
+    Napi::Buffer<uint8_t> data;
+    switch (audioFormat)
+    {
+    case Grandiose_audio_format_int_16_interleaved:
+    {
+      size_t length = std::max(count * sizeof(short), (size_t)(frame.channel_stride_in_bytes / 2) * frame.no_channels);
+      data = Napi::Buffer<uint8_t>::New(env, length);
+      NDIlib_audio_frame_interleaved_16s_t interleaved;
+      interleaved.reference_level = (int)referenceLevel;
+      interleaved.p_data = (short *)data.Data();
+      ndiLib->util_audio_to_interleaved_16s_v2(&frame, &interleaved);
+      break;
+    }
+    case Grandiose_audio_format_float_32_interleaved:
+    {
+      size_t length = std::max(count * sizeof(float), (size_t)frame.channel_stride_in_bytes * frame.no_channels);
+      data = Napi::Buffer<uint8_t>::New(env, length);
+      NDIlib_audio_frame_interleaved_32f_t interleaved;
+      interleaved.p_data = (float *)data.Data();
+      ndiLib->util_audio_to_interleaved_32f_v2(&frame, &interleaved);
+      break;
+    }
+    case Grandiose_audio_format_float_32_separate:
+    default:
+      data = Napi::Buffer<uint8_t>::Copy(env, captured.p_data,
+                                         (size_t)frame.channel_stride_in_bytes * frame.no_channels);
+      break;
+    }
+    status = napi_set_named_property(env, result, "data", data);
+    if (status == napi_ok && audioFormat == Grandiose_audio_format_float_32_separate)
+    {
+      napi_value channelData;
+      status = planarChannelsToJs(env, data, frame.no_channels, frame.no_samples,
+                                  frame.channel_stride_in_bytes, &channelData);
+      if (status == napi_ok)
+        status = napi_set_named_property(env, result, "channelData", channelData);
+    }
+  }
+  ndiLib->framesync_free_audio_v2(handle, &captured);
+
+  if (status != napi_ok)
+  {
+    checkStatus(env, status, __FILE__, __LINE__);
+    return env.Null();
+  }
+  return Napi::Value(env, result);
+}
+
+Napi::Value GrandioseFrameSync::AudioQueueDepth(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  if (!handle)
+  {
+    Napi::Error::New(env, "GrandioseFrameSync has been destroyed").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Number::New(env, ndiLib->framesync_audio_queue_depth(handle));
+}
+
+Napi::Value createFrameSync(const Napi::CallbackInfo &info, receiverState *receiver)
+{
+  Napi::Env env = info.Env();
+
+  GrandioseInstanceData *instance = env.GetInstanceData<GrandioseInstanceData>();
+  Napi::Object frameSync;
+  if (!newInternal(*instance->frameSync, receiver).UnwrapTo(&frameSync))
+    return env.Undefined();
+  return frameSync;
+}
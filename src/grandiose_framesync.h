@@ -0,0 +1,49 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#pragma once
+
+#include "napi.h"
+#include "grandiose_util.h"
+#include "grandiose_receive.h"
+#include <cstddef>
+#include <Processing.NDI.Lib.h>
+
+// Frame synchronizer on top of a receiver. Captures never block: video returns
+// the most recent frame and audio is resampled to exactly the number of samples
+// asked for, so the caller's clock drives playout.
+class GrandioseFrameSync : public Napi::ObjectWrap<GrandioseFrameSync>
+{
+public:
+  GrandioseFrameSync(const Napi::CallbackInfo &info);
+  static std::unique_ptr<Napi::FunctionReference> Initialize(const Napi::Env &env);
+
+  ~GrandioseFrameSync();
+
+private:
+  Napi::Value Destroy(const Napi::CallbackInfo &info);
+
+  Napi::Value Video(const Napi::CallbackInfo &info);
+  Napi::Value Audio(const Napi::CallbackInfo &info);
+  Napi::Value AudioQueueDepth(const Napi::CallbackInfo &info);
+
+  void cleanup();
+
+  receiverState *receiver = nullptr;
+  NDIlib_framesync_instance_t handle = nullptr;
+};
+
+// receiver.frameSync()
+Napi::Value createFrameSync(const Napi::CallbackInfo &info, receiverState *receiver);
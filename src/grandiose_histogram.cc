@@ -0,0 +1,170 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <algorithm>
+#include "grandiose_histogram.h"
+#include "grandiose_util.h"
+
+latencyHistogram::latencyHistogram()
+{
+  for (std::atomic<uint64_t> &bucket : buckets)
+    bucket.store(0, std::memory_order_relaxed);
+}
+
+uint32_t histogramBucket(uint64_t nanoseconds)
+{
+  const uint64_t limit = (1ULL << HISTOGRAM_MAX_BITS) - 1;
+  if (nanoseconds > limit)
+    nanoseconds = limit;
+  if (nanoseconds < 2 * HISTOGRAM_SUB_BUCKETS)
+    return (uint32_t)nanoseconds;
+
+  uint32_t msb = 63;
+  while ((nanoseconds >> msb) == 0)
+    msb--;
+  // Keep the top five bits, the leading one and four for the sub-bucket
+  uint32_t shift = msb - 4;
+  return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (uint32_t)(nanoseconds >> shift) - HISTOGRAM_SUB_BUCKETS;
+}
+
+uint64_t histogramBucketLimit(uint32_t bucket)
+{
+  if (bucket < 2 * HISTOGRAM_SUB_BUCKETS)
+    return bucket;
+  uint32_t shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+  uint64_t mantissa = HISTOGRAM_SUB_BUCKETS + bucket % HISTOGRAM_SUB_BUCKETS;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+void latencyHistogram::record(uint64_t nanoseconds)
+{
+  buckets[histogramBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+  count.fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+  uint64_t current = min.load(std::memory_order_relaxed);
+  while (nanoseconds < current && !min.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed))
+    ;
+  current = max.load(std::memory_order_relaxed);
+  while (nanoseconds > current && !max.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed))
+    ;
+}
+
+void latencyHistogram::recordSince(std::chrono::high_resolution_clock::time_point start)
+{
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(NOW - start).count();
+  record(elapsed > 0 ? (uint64_t)elapsed : 0);
+}
+
+// Frames recorded while resetting may be lost or only partly cleared
+void latencyHistogram::reset()
+{
+  for (std::atomic<uint64_t> &bucket : buckets)
+    bucket.store(0, std::memory_order_relaxed);
+  count.store(0, std::memory_order_relaxed);
+  sum.store(0, std::memory_order_relaxed);
+  min.store(UINT64_MAX, std::memory_order_relaxed);
+  max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t histogramPercentile(const latencyHistogram &h, double fraction)
+{
+  uint64_t total = 0;
+  uint64_t counts[HISTOGRAM_BUCKETS];
+  for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+  {
+    counts[i] = h.buckets[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0)
+    return 0;
+
+  uint64_t wanted = (uint64_t)(fraction * (double)total);
+  if (wanted >= total)
+    wanted = total - 1;
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+  {
+    seen += counts[i];
+    if (seen > wanted)
+      return std::min(histogramBucketLimit(i), h.max.load(std::memory_order_relaxed));
+  }
+  return h.max.load(std::memory_order_relaxed);
+}
+
+static napi_status setMicroseconds(napi_env env, napi_value object, const char *name, double nanoseconds)
+{
+  napi_status status;
+  napi_value value;
+  status = napi_create_double(env, nanoseconds / 1000.0, &value);
+  PASS_STATUS;
+  return napi_set_named_property(env, object, name, value);
+}
+
+napi_status histogramToJs(napi_env env, const latencyHistogram &h, napi_value *result)
+{
+  napi_status status;
+  status = napi_create_object(env, result);
+  PASS_STATUS;
+
+  uint64_t count = h.count.load(std::memory_order_relaxed);
+  napi_value value;
+  status = napi_create_double(env, (double)count, &value);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "count", value);
+  PASS_STATUS;
+
+  uint64_t min = h.min.load(std::memory_order_relaxed);
+  status = setMicroseconds(env, *result, "min", count > 0 && min != UINT64_MAX ? (double)min : 0.0);
+  PASS_STATUS;
+  status = setMicroseconds(env, *result, "max", (double)h.max.load(std::memory_order_relaxed));
+  PASS_STATUS;
+  status = setMicroseconds(env, *result, "mean",
+                           count > 0 ? (double)h.sum.load(std::memory_order_relaxed) / count : 0.0);
+  PASS_STATUS;
+  status = setMicroseconds(env, *result, "p50", (double)histogramPercentile(h, 0.5));
+  PASS_STATUS;
+  status = setMicroseconds(env, *result, "p90", (double)histogramPercentile(h, 0.9));
+  PASS_STATUS;
+  status = setMicroseconds(env, *result, "p99", (double)histogramPercentile(h, 0.99));
+  PASS_STATUS;
+  status = setMicroseconds(env, *result, "p999", (double)histogramPercentile(h, 0.999));
+  PASS_STATUS;
+
+  napi_value buckets;
+  status = napi_create_array(env, &buckets);
+  PASS_STATUS;
+  uint32_t index = 0;
+  for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+  {
+    uint64_t bucketCount = h.buckets[i].load(std::memory_order_relaxed);
+    if (bucketCount == 0)
+      continue;
+    napi_value pair, limit, n;
+    status = napi_create_array_with_length(env, 2, &pair);
+    PASS_STATUS;
+    status = napi_create_double(env, (double)histogramBucketLimit(i) / 1000.0, &limit);
+    PASS_STATUS;
+    status = napi_create_double(env, (double)bucketCount, &n);
+    PASS_STATUS;
+    status = napi_set_element(env, pair, 0, limit);
+    PASS_STATUS;
+    status = napi_set_element(env, pair, 1, n);
+    PASS_STATUS;
+    status = napi_set_element(env, buckets, index++, pair);
+    PASS_STATUS;
+  }
+  return napi_set_named_property(env, *result, "buckets", buckets);
+}
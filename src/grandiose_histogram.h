@@ -0,0 +1,55 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_HISTOGRAM_H
+#define GRANDIOSE_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "node_api.h"
+
+// Latencies are kept in HDR-style log-linear buckets: exact below 32ns, then
+// 16 buckets for each power of two, so any value is within about 6% of its
+// bucket. Recording is a few relaxed atomic adds, safe from any thread.
+
+#define HISTOGRAM_SUB_BUCKETS 16
+#define HISTOGRAM_MAX_BITS 40 // about 18 minutes in nanoseconds
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BITS - 3) * HISTOGRAM_SUB_BUCKETS)
+
+struct latencyHistogram {
+  std::atomic<uint64_t> buckets[HISTOGRAM_BUCKETS];
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sum{0};
+  std::atomic<uint64_t> min{UINT64_MAX};
+  std::atomic<uint64_t> max{0};
+
+  latencyHistogram();
+  void record(uint64_t nanoseconds);
+  void recordSince(std::chrono::high_resolution_clock::time_point start);
+  void reset();
+};
+
+uint32_t histogramBucket(uint64_t nanoseconds);
+// Largest value that falls into a bucket
+uint64_t histogramBucketLimit(uint32_t bucket);
+// Value below which a fraction of those recorded fall, 0 if there are none
+uint64_t histogramPercentile(const latencyHistogram& h, double fraction);
+
+// { count, min, max, mean, p50, p90, p99, p999, buckets } in microseconds,
+// with buckets as [ limit, count ] pairs for the buckets that are not empty
+napi_status histogramToJs(napi_env env, const latencyHistogram& h, napi_value* result);
+
+#endif /* GRANDIOSE_HISTOGRAM_H */
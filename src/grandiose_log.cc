@@ -0,0 +1,297 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "grandiose_log.h"
+#include "grandiose_util.h"
+
+std::atomic<int32_t> logLevel{GRANDIOSE_LOG_WARN};
+
+static const char* levelNames[] = { "error", "warn", "info", "debug" };
+
+struct logEntry {
+  int32_t level;
+  int64_t time; // milliseconds since the epoch
+  char message[LOG_MESSAGE_SIZE];
+};
+
+// Shared by all environments in the process and never torn down, like the
+// executor pool, as the writer may be blocked on stderr at exit
+struct logRing {
+  std::mutex lock;
+  std::condition_variable wake;
+  logEntry entries[LOG_RING_SIZE];
+  uint32_t head = 0;
+  uint32_t count = 0;
+  uint64_t dropped = 0; // messages lost to a full ring
+  bool urgent = false; // write without waiting to batch
+  bool started = false;
+
+  // Where batches go instead of stderr, if set
+  std::mutex sinkLock;
+  napi_threadsafe_function sink = nullptr;
+};
+
+static logRing* ring = new logRing;
+
+static int64_t wallTime() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static void writeBatch(std::vector<logEntry>& batch) {
+  {
+    std::lock_guard<std::mutex> guard(ring->sinkLock);
+    if (ring->sink != nullptr) {
+      std::vector<logEntry>* entries = new std::vector<logEntry>(std::move(batch));
+      if (napi_call_threadsafe_function(ring->sink, entries, napi_tsfn_nonblocking) != napi_ok)
+        delete entries;
+      batch.clear();
+      return;
+    }
+  }
+
+  for (const logEntry& entry : batch) {
+    fprintf(stderr, "grandiose %s: %s\n", levelNames[entry.level], entry.message);
+  }
+  batch.clear();
+}
+
+static void logWriter() {
+  std::vector<logEntry> batch;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> guard(ring->lock);
+      ring->wake.wait(guard, [] { return ring->count > 0; });
+      // Gather whatever else arrives shortly into the same batch
+      if (!ring->urgent)
+        ring->wake.wait_for(guard, std::chrono::milliseconds(LOG_FLUSH_MS), [] { return ring->urgent; });
+
+      for (; ring->count > 0; ring->count--) {
+        batch.push_back(ring->entries[ring->head]);
+        ring->head = (ring->head + 1) % LOG_RING_SIZE;
+      }
+      if (ring->dropped > 0) {
+        logEntry entry;
+        entry.level = GRANDIOSE_LOG_WARN;
+        entry.time = wallTime();
+        snprintf(entry.message, LOG_MESSAGE_SIZE, "%llu log messages dropped as the log was full.",
+          (unsigned long long) ring->dropped);
+        batch.push_back(entry);
+        ring->dropped = 0;
+      }
+      ring->urgent = false;
+    }
+
+    writeBatch(batch);
+  }
+}
+
+void logMessage(logSite* site, int32_t level, const char* format, ...) {
+  int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  int64_t windowStart = site->windowStart.load(std::memory_order_relaxed);
+  if (now - windowStart >= 1000 &&
+      site->windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+    site->count.store(0, std::memory_order_relaxed);
+  if (site->count.fetch_add(1, std::memory_order_relaxed) >= LOG_RATE_LIMIT) {
+    site->suppressed.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  logEntry entry;
+  entry.level = level;
+  entry.time = wallTime();
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(entry.message, LOG_MESSAGE_SIZE, format, args);
+  va_end(args);
+  if (length < 0) return;
+
+  uint32_t suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+  if (suppressed > 0) {
+    size_t used = strlen(entry.message);
+    snprintf(entry.message + used, LOG_MESSAGE_SIZE - used, " (%u more suppressed)", suppressed);
+  }
+
+  bool notify;
+  {
+    std::lock_guard<std::mutex> guard(ring->lock);
+    if (!ring->started) {
+      std::thread(logWriter).detach();
+      ring->started = true;
+    }
+    if (ring->count == LOG_RING_SIZE) {
+      ring->dropped++;
+      return;
+    }
+    ring->entries[(ring->head + ring->count) % LOG_RING_SIZE] = entry;
+    ring->count++;
+
+    // Wake the writer when it is idle, and again if it should not wait
+    bool urgent = level == GRANDIOSE_LOG_ERROR || ring->count >= LOG_RING_SIZE / 2;
+    notify = ring->count == 1 || (urgent && !ring->urgent);
+    ring->urgent = ring->urgent || urgent;
+  }
+  if (notify)
+    ring->wake.notify_one();
+}
+
+bool setLogLevelName(const char* name) {
+  if (strcmp(name, "off") == 0) {
+    logLevel = GRANDIOSE_LOG_OFF;
+    return true;
+  }
+  for (int32_t level = GRANDIOSE_LOG_ERROR; level <= GRANDIOSE_LOG_DEBUG; level++) {
+    if (strcmp(name, levelNames[level]) == 0) {
+      logLevel = level;
+      return true;
+    }
+  }
+  return false;
+}
+
+napi_value setLogLevel(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  CHECK_STATUS;
+  if (argc < 1) NAPI_THROW_ERROR("Log level must be provided.");
+
+  napi_valuetype type;
+  status = napi_typeof(env, args[0], &type);
+  CHECK_STATUS;
+  if (type != napi_string) NAPI_THROW_ERROR("Log level must be a string.");
+
+  char name[16];
+  status = napi_get_value_string_utf8(env, args[0], name, sizeof(name), nullptr);
+  CHECK_STATUS;
+  if (!setLogLevelName(name))
+    NAPI_THROW_ERROR("Log level must be one of 'off', 'error', 'warn', 'info' or 'debug'.");
+
+  napi_value result;
+  status = napi_get_undefined(env, &result);
+  CHECK_STATUS;
+  return result;
+}
+
+// The sink a thread-safe function was created for, known once it exists
+struct logSinkRef {
+  napi_threadsafe_function tsfn = nullptr;
+};
+
+static void finalizeLogSink(napi_env env, void* data, void* hint) {
+  logSinkRef* ref = (logSinkRef*) data;
+  {
+    std::lock_guard<std::mutex> guard(ring->sinkLock);
+    if (ring->sink == ref->tsfn)
+      ring->sink = nullptr;
+  }
+  delete ref;
+}
+
+static void deliverLogBatch(napi_env env, napi_value callback, void* context, void* data) {
+  std::vector<logEntry>* entries = (std::vector<logEntry>*) data;
+  if (env == nullptr) { // environment is shutting down
+    delete entries;
+    return;
+  }
+
+  napi_status status;
+  napi_value batch, item, value, undefined;
+  status = napi_create_array_with_length(env, entries->size(), &batch);
+  for (size_t i = 0; status == napi_ok && i < entries->size(); i++) {
+    const logEntry& entry = (*entries)[i];
+    status = napi_create_object(env, &item);
+    if (status != napi_ok) break;
+    status = napi_create_string_utf8(env, levelNames[entry.level], NAPI_AUTO_LENGTH, &value);
+    if (status != napi_ok) break;
+    status = napi_set_named_property(env, item, "level", value);
+    if (status != napi_ok) break;
+    status = napi_create_string_utf8(env, entry.message, NAPI_AUTO_LENGTH, &value);
+    if (status != napi_ok) break;
+    status = napi_set_named_property(env, item, "message", value);
+    if (status != napi_ok) break;
+    status = napi_create_double(env, (double) entry.time, &value);
+    if (status != napi_ok) break;
+    status = napi_set_named_property(env, item, "time", value);
+    if (status != napi_ok) break;
+    status = napi_set_element(env, batch, (uint32_t) i, item);
+  }
+  delete entries;
+
+  if (status == napi_ok)
+    status = napi_get_undefined(env, &undefined);
+  if (status == napi_ok)
+    napi_call_function(env, undefined, callback, 1, &batch, nullptr);
+}
+
+// Route messages to a callback, or back to stderr when called with null
+napi_value setLogCallback(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  CHECK_STATUS;
+
+  napi_valuetype type = napi_undefined;
+  if (argc >= 1) {
+    status = napi_typeof(env, args[0], &type);
+    CHECK_STATUS;
+  }
+  if (type != napi_function && type != napi_null && type != napi_undefined)
+    NAPI_THROW_ERROR("Log callback must be a function or null.");
+
+  napi_threadsafe_function sink = nullptr;
+  if (type == napi_function) {
+    napi_value resourceName;
+    status = napi_create_string_utf8(env, "GrandioseLog", NAPI_AUTO_LENGTH, &resourceName);
+    CHECK_STATUS;
+    logSinkRef* ref = new logSinkRef;
+    status = napi_create_threadsafe_function(env, args[0], nullptr, resourceName, 0, 1,
+      ref, finalizeLogSink, nullptr, deliverLogBatch, &sink);
+    if (status != napi_ok) delete ref;
+    CHECK_STATUS;
+    ref->tsfn = sink;
+    // Logging alone does not keep the process alive
+    status = napi_unref_threadsafe_function(env, sink);
+    CHECK_STATUS;
+  }
+
+  napi_threadsafe_function previous;
+  {
+    std::lock_guard<std::mutex> guard(ring->sinkLock);
+    previous = ring->sink;
+    ring->sink = sink;
+  }
+  if (previous != nullptr)
+    napi_release_threadsafe_function(previous, napi_tsfn_release);
+
+  napi_value result;
+  status = napi_get_undefined(env, &result);
+  CHECK_STATUS;
+  return result;
+}
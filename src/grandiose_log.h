@@ -0,0 +1,75 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_LOG_H
+#define GRANDIOSE_LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include "node_api.h"
+
+// Levelled logging that is safe to call from capture loops. Messages below
+// the current level cost one relaxed load. Others are formatted into a ring
+// that a background thread drains, to stderr or in batches to a JavaScript
+// callback, so no caller ever waits on output. Each call site is limited to
+// LOG_RATE_LIMIT messages a second, with the number suppressed reported on
+// the next message from that site.
+
+#define GRANDIOSE_LOG_OFF -1
+#define GRANDIOSE_LOG_ERROR 0
+#define GRANDIOSE_LOG_WARN 1
+#define GRANDIOSE_LOG_INFO 2
+#define GRANDIOSE_LOG_DEBUG 3
+
+#define LOG_RING_SIZE 1024 // messages waiting to be written
+#define LOG_MESSAGE_SIZE 240
+#define LOG_RATE_LIMIT 10 // per call site per second
+#define LOG_FLUSH_MS 100 // longest a message waits before being written
+
+extern std::atomic<int32_t> logLevel;
+
+// Rate limiting state, one per call site
+struct logSite {
+  std::atomic<int64_t> windowStart{0}; // milliseconds
+  std::atomic<uint32_t> count{0};
+  std::atomic<uint32_t> suppressed{0};
+};
+
+void logMessage(logSite* site, int32_t level, const char* format, ...)
+#ifdef __GNUC__
+  __attribute__((format(printf, 3, 4)))
+#endif
+  ;
+
+#define GRANDIOSE_LOG(level, ...) do { \
+  if ((level) <= logLevel.load(std::memory_order_relaxed)) { \
+    static logSite site; \
+    logMessage(&site, (level), __VA_ARGS__); \
+  } \
+} while (0)
+
+#define LOG_ERROR(...) GRANDIOSE_LOG(GRANDIOSE_LOG_ERROR, __VA_ARGS__)
+#define LOG_WARN(...) GRANDIOSE_LOG(GRANDIOSE_LOG_WARN, __VA_ARGS__)
+#define LOG_INFO(...) GRANDIOSE_LOG(GRANDIOSE_LOG_INFO, __VA_ARGS__)
+#define LOG_DEBUG(...) GRANDIOSE_LOG(GRANDIOSE_LOG_DEBUG, __VA_ARGS__)
+
+// Set the level from a name, such as from the GRANDIOSE_LOG_LEVEL environment
+// variable. Returns false if the name is not known.
+bool setLogLevelName(const char* name);
+
+napi_value setLogLevel(napi_env env, napi_callback_info info);
+napi_value setLogCallback(napi_env env, napi_callback_info info);
+
+#endif /* GRANDIOSE_LOG_H */
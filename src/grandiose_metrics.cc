@@ -0,0 +1,207 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "grandiose_metrics.h"
+#include "grandiose_receive.h"
+#include "grandiose_send.h"
+#include "grandiose_util.h"
+
+grandioseMetrics metrics;
+
+static const char* typeNames[METRIC_TYPES] = { "video", "audio", "metadata" };
+
+// Histogram buckets exported, in seconds. Each is filled from the finer
+// buckets kept natively that fall entirely below it.
+static const double exportBuckets[] = {
+  0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5
+};
+
+static std::mutex receiversLock;
+static std::unordered_set<receiverState*> liveReceivers;
+static uint64_t retiredDropped[METRIC_TYPES] = {}; // from receivers since destroyed
+
+uint64_t videoFrameBytes(const NDIlib_video_frame_v2_t& frame) {
+  return videoFrameSize(frame.FourCC, frame.xres, frame.yres, frame.line_stride_in_bytes);
+}
+
+uint64_t audioFrameBytes(const NDIlib_audio_frame_v3_t& frame) {
+  return (uint64_t) frame.channel_stride_in_bytes * frame.no_channels;
+}
+
+uint64_t metadataFrameBytes(const NDIlib_metadata_frame_t& frame) {
+  return frame.length > 0 ? (uint64_t) frame.length : 0;
+}
+
+void trackReceiver(receiverState* r) {
+  std::lock_guard<std::mutex> guard(receiversLock);
+  liveReceivers.insert(r);
+}
+
+void untrackReceiver(receiverState* r) {
+  std::lock_guard<std::mutex> guard(receiversLock);
+  if (liveReceivers.erase(r) == 0) return;
+  NDIlib_recv_performance_t dropped;
+  ndiLib->recv_get_performance(r->recv, nullptr, &dropped);
+  retiredDropped[METRIC_VIDEO] += dropped.video_frames;
+  retiredDropped[METRIC_AUDIO] += dropped.audio_frames;
+  retiredDropped[METRIC_METADATA] += dropped.metadata_frames;
+}
+
+static void appendf(std::string& text, const char* format, ...)
+#ifdef __GNUC__
+  __attribute__((format(printf, 2, 3)))
+#endif
+  ;
+
+static void appendf(std::string& text, const char* format, ...) {
+  char line[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (length > 0)
+    text.append(line, length < (int) sizeof(line) ? length : sizeof(line) - 1);
+}
+
+static void appendHeader(std::string& text, const char* name, const char* type, const char* help) {
+  appendf(text, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void appendByType(std::string& text, const char* name, const char* help,
+    const std::atomic<uint64_t>* values) {
+  appendHeader(text, name, "counter", help);
+  for (int32_t i = 0; i < METRIC_TYPES; i++) {
+    appendf(text, "%s{type=\"%s\"} %" PRIu64 "\n", name, typeNames[i],
+      values[i].load(std::memory_order_relaxed));
+  }
+}
+
+static void appendCounter(std::string& text, const char* name, const char* help, uint64_t value) {
+  appendHeader(text, name, "counter", help);
+  appendf(text, "%s %" PRIu64 "\n", name, value);
+}
+
+static void appendGauge(std::string& text, const char* name, const char* help, int64_t value) {
+  appendHeader(text, name, "gauge", help);
+  appendf(text, "%s %" PRId64 "\n", name, value);
+}
+
+// Video and audio histograms of one measure, in seconds
+static void appendHistograms(std::string& text, const char* name, const char* help,
+    const latencyHistogram* histograms) {
+  appendHeader(text, name, "histogram", help);
+  for (int32_t i = 0; i < 2; i++) {
+    const latencyHistogram& h = histograms[i];
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t total = 0;
+    for (uint32_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+      counts[b] = h.buckets[b].load(std::memory_order_relaxed);
+      total += counts[b];
+    }
+
+    uint32_t b = 0;
+    uint64_t cumulative = 0;
+    for (double le : exportBuckets) {
+      uint64_t limit = (uint64_t) (le * 1e9);
+      for (; b < HISTOGRAM_BUCKETS && histogramBucketLimit(b) <= limit; b++)
+        cumulative += counts[b];
+      appendf(text, "%s_bucket{type=\"%s\",le=\"%g\"} %" PRIu64 "\n", name, typeNames[i], le, cumulative);
+    }
+    appendf(text, "%s_bucket{type=\"%s\",le=\"+Inf\"} %" PRIu64 "\n", name, typeNames[i], total);
+    appendf(text, "%s_sum{type=\"%s\"} %.9f\n", name, typeNames[i],
+      (double) h.sum.load(std::memory_order_relaxed) / 1e9);
+    appendf(text, "%s_count{type=\"%s\"} %" PRIu64 "\n", name, typeNames[i], total);
+  }
+}
+
+napi_value metricsText(napi_env env, napi_callback_info info) {
+  napi_status status;
+  std::string text;
+
+  int64_t receivers;
+  uint64_t dropped[METRIC_TYPES];
+  {
+    std::lock_guard<std::mutex> guard(receiversLock);
+    receivers = (int64_t) liveReceivers.size();
+    for (int32_t i = 0; i < METRIC_TYPES; i++)
+      dropped[i] = retiredDropped[i];
+    for (receiverState* r : liveReceivers) {
+      NDIlib_recv_performance_t live;
+      ndiLib->recv_get_performance(r->recv, nullptr, &live);
+      dropped[METRIC_VIDEO] += live.video_frames;
+      dropped[METRIC_AUDIO] += live.audio_frames;
+      dropped[METRIC_METADATA] += live.metadata_frames;
+    }
+  }
+
+  appendGauge(text, "grandiose_receivers", "NDI receivers alive.", receivers);
+  appendGauge(text, "grandiose_senders", "NDI senders alive.",
+    metrics.senders.load(std::memory_order_relaxed));
+  appendGauge(text, "grandiose_finders", "NDI finders alive.",
+    metrics.finders.load(std::memory_order_relaxed));
+  appendGauge(text, "grandiose_routers", "NDI routers alive.",
+    metrics.routers.load(std::memory_order_relaxed));
+
+  appendByType(text, "grandiose_received_frames_total", "Frames captured from NDI.",
+    metrics.framesReceived);
+  appendByType(text, "grandiose_received_bytes_total", "Bytes of frames captured from NDI.",
+    metrics.bytesReceived);
+  appendByType(text, "grandiose_sent_frames_total", "Frames sent to NDI.", metrics.framesSent);
+  appendByType(text, "grandiose_sent_bytes_total", "Bytes of frames sent to NDI.", metrics.bytesSent);
+
+  appendHeader(text, "grandiose_ndi_dropped_frames_total", "counter", "Frames dropped by NDI receivers.");
+  for (int32_t i = 0; i < METRIC_TYPES; i++) {
+    appendf(text, "grandiose_ndi_dropped_frames_total{type=\"%s\"} %" PRIu64 "\n", typeNames[i], dropped[i]);
+  }
+  appendCounter(text, "grandiose_skipped_frames_total", "Stale video frames skipped by receivers with latest set.",
+    metrics.skipped.load(std::memory_order_relaxed));
+  appendCounter(text, "grandiose_stream_dropped_frames_total", "Frames dropped from full receiver stream rings.",
+    metrics.streamDropped.load(std::memory_order_relaxed));
+  appendCounter(text, "grandiose_captures_total", "Capture calls made to NDI receivers.",
+    metrics.captures.load(std::memory_order_relaxed));
+  appendCounter(text, "grandiose_capture_timeouts_total", "Captures that returned no frame in time.",
+    metrics.timeouts.load(std::memory_order_relaxed));
+  appendCounter(text, "grandiose_copied_bytes_total", "Bytes of frame data copied into JavaScript buffers.",
+    metrics.bytesCopied.load(std::memory_order_relaxed));
+  appendCounter(text, "grandiose_carriers_allocated_total", "Per-frame carriers allocated because none were spare.",
+    metrics.carriersAllocated.load(std::memory_order_relaxed));
+
+  appendHistograms(text, "grandiose_receive_ndi_latency_seconds",
+    "Time from a frame's NDI timestamp to its capture.", metrics.receiveNdiLatency);
+  appendHistograms(text, "grandiose_receive_latency_seconds",
+    "Time from a frame's capture to the resolution of its promise.", metrics.receiveLatency);
+  appendHistograms(text, "grandiose_send_duration_seconds",
+    "Time taken by NDI to send a frame, including clocking.", metrics.sendDuration);
+
+  executorStats executor = getExecutorStats();
+  appendGauge(text, "grandiose_executor_threads", "Executor threads started.", executor.threads);
+  appendGauge(text, "grandiose_executor_busy_threads", "Executor threads running work.", executor.busy);
+  appendGauge(text, "grandiose_executor_queued", "Work waiting for an executor thread.", executor.queued);
+  appendCounter(text, "grandiose_executor_completed_total", "Work completed by the executor.", executor.completed);
+  appendHeader(text, "grandiose_executor_busy_seconds_total", "counter", "Time executor threads have spent running work.");
+  appendf(text, "grandiose_executor_busy_seconds_total %.6f\n", (double) executor.busyTime / 1e6);
+
+  napi_value result;
+  status = napi_create_string_utf8(env, text.c_str(), text.length(), &result);
+  CHECK_STATUS;
+  return result;
+}
@@ -0,0 +1,90 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_METRICS_H
+#define GRANDIOSE_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <Processing.NDI.Lib.h>
+#include "node_api.h"
+#include "grandiose_histogram.h"
+
+// Process-wide counters for grandiose.metrics(), kept alongside the per
+// object statistics with relaxed atomics. Unlike those, they are never reset
+// and include objects that have since been destroyed, as Prometheus expects.
+
+#define METRIC_VIDEO 0
+#define METRIC_AUDIO 1
+#define METRIC_METADATA 2
+#define METRIC_TYPES 3
+
+struct receiverState;
+
+struct grandioseMetrics {
+  // NDI instances that are currently alive
+  std::atomic<int64_t> senders{0};
+  std::atomic<int64_t> finders{0};
+  std::atomic<int64_t> routers{0};
+
+  std::atomic<uint64_t> framesReceived[METRIC_TYPES]{};
+  std::atomic<uint64_t> bytesReceived[METRIC_TYPES]{};
+  std::atomic<uint64_t> framesSent[METRIC_TYPES]{};
+  std::atomic<uint64_t> bytesSent[METRIC_TYPES]{};
+  std::atomic<uint64_t> captures{0};
+  std::atomic<uint64_t> timeouts{0};
+  std::atomic<uint64_t> bytesCopied{0};
+  std::atomic<uint64_t> skipped{0}; // stale frames skipped by latest mode
+  std::atomic<uint64_t> streamDropped{0}; // frames dropped from full stream rings
+  std::atomic<uint64_t> carriersAllocated{0}; // per-frame carriers not found spare
+
+  // Video and audio only
+  latencyHistogram receiveNdiLatency[2]; // NDI timestamp to capture
+  latencyHistogram receiveLatency[2]; // capture to promise resolution
+  latencyHistogram sendDuration[2]; // the NDI send call, including clocking
+};
+
+extern grandioseMetrics metrics;
+
+// Index into the metrics arrays for a frame type, or -1 for other types
+inline int32_t metricIndex(NDIlib_frame_type_e type) {
+  switch (type) {
+  case NDIlib_frame_type_video: return METRIC_VIDEO;
+  case NDIlib_frame_type_audio: return METRIC_AUDIO;
+  case NDIlib_frame_type_metadata: return METRIC_METADATA;
+  default: return -1;
+  }
+}
+
+inline void countFrame(std::atomic<uint64_t>* frames, std::atomic<uint64_t>* bytes,
+    int32_t index, uint64_t size) {
+  frames[index].fetch_add(1, std::memory_order_relaxed);
+  bytes[index].fetch_add(size, std::memory_order_relaxed);
+}
+
+// Bytes of a frame as NDI passes it, for frames in and out
+uint64_t videoFrameBytes(const NDIlib_video_frame_v2_t& frame);
+uint64_t audioFrameBytes(const NDIlib_audio_frame_v3_t& frame);
+uint64_t metadataFrameBytes(const NDIlib_metadata_frame_t& frame);
+
+// Live receivers are tracked so that frames dropped by NDI can be read from
+// them when scraped. Untrack before destroying the NDI receiver.
+void trackReceiver(receiverState* r);
+void untrackReceiver(receiverState* r);
+
+// Prometheus text exposition format, version 0.0.4
+napi_value metricsText(napi_env env, napi_callback_info info);
+
+#endif /* GRANDIOSE_METRICS_H */
@@ -0,0 +1,234 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "grandiose_ndi.h"
+#include "grandiose_util.h"
+
+const NDIlib_v5* ndiLib = nullptr;
+
+typedef const NDIlib_v5* (*ndiLoadFn)(void);
+
+static std::mutex ndiLock;
+static std::atomic<bool> ndiLoaded{false};
+static const NDIlib_v5* opened = nullptr; // loaded, but maybe not initialized
+static std::string configuredPath; // from setLibraryPath()
+static std::string loadedPath;
+
+#ifndef GRANDIOSE_NDI_STATIC
+
+#ifdef _WIN32
+#define PATH_SEPARATOR "\\"
+#else
+#define PATH_SEPARATOR "/"
+#endif
+
+// The folder holding this addon, or empty if it cannot be found
+static std::string addonFolder() {
+  std::string path;
+#ifdef _WIN32
+  HMODULE module;
+  char name[MAX_PATH];
+  if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+        (LPCSTR) &addonFolder, &module) &&
+      GetModuleFileNameA(module, name, MAX_PATH) > 0)
+    path = name;
+  size_t slash = path.find_last_of("\\/");
+#else
+  Dl_info info;
+  if (dladdr((void*) &addonFolder, &info) != 0 && info.dli_fname != nullptr)
+    path = info.dli_fname;
+  size_t slash = path.find_last_of('/');
+#endif
+  return slash == std::string::npos ? std::string() : path.substr(0, slash);
+}
+
+static std::vector<std::string> libraryCandidates() {
+  std::vector<std::string> candidates;
+  if (!configuredPath.empty()) {
+    candidates.push_back(configuredPath);
+    return candidates;
+  }
+  const char* env = getenv("GRANDIOSE_NDI_LIBRARY");
+  if (env != nullptr && env[0] != '\0') {
+    candidates.push_back(env);
+    return candidates;
+  }
+
+  const char* runtime = getenv(NDILIB_REDIST_FOLDER);
+  if (runtime != nullptr && runtime[0] != '\0')
+    candidates.push_back(std::string(runtime) + PATH_SEPARATOR NDILIB_LIBRARY_NAME);
+
+  // As installed, build/Release/grandiose.node and the SDK's lib folder
+  std::string folder = addonFolder();
+  if (!folder.empty()) {
+#if defined(_WIN32)
+    // Copied next to the addon by binding.gyp
+    candidates.push_back(folder + PATH_SEPARATOR NDILIB_LIBRARY_NAME);
+#elif defined(__APPLE__)
+    candidates.push_back(folder + "/../../lib/mac_universal/" NDILIB_LIBRARY_NAME);
+#elif defined(__aarch64__)
+    candidates.push_back(folder + "/../../lib/linux_arm64/" NDILIB_LIBRARY_NAME);
+#else
+    candidates.push_back(folder + "/../../lib/linux_x64/" NDILIB_LIBRARY_NAME);
+#endif
+  }
+
+  candidates.push_back(NDILIB_LIBRARY_NAME);
+  return candidates;
+}
+
+// Find NDIlib_v5_load() in the first library that opens. Libraries are never
+// closed, as NDI instances may outlive any one environment.
+static ndiLoadFn openLibrary(std::string& error) {
+  std::string tried;
+  std::string reason;
+  for (const std::string& candidate : libraryCandidates()) {
+#ifdef _WIN32
+    HMODULE library = LoadLibraryA(candidate.c_str());
+    if (library == nullptr) {
+      reason = "error " + std::to_string(GetLastError());
+    } else {
+      ndiLoadFn load = (ndiLoadFn) GetProcAddress(library, "NDIlib_v5_load");
+      if (load != nullptr) {
+        loadedPath = candidate;
+        return load;
+      }
+      reason = candidate + " does not export NDIlib_v5_load";
+      FreeLibrary(library);
+    }
+#else
+    void* library = dlopen(candidate.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (library == nullptr) {
+      const char* message = dlerror();
+      reason = message != nullptr ? message : "unknown error";
+    } else {
+      ndiLoadFn load = (ndiLoadFn) dlsym(library, "NDIlib_v5_load");
+      if (load != nullptr) {
+        loadedPath = candidate;
+        return load;
+      }
+      reason = candidate + " does not export NDIlib_v5_load";
+      dlclose(library);
+    }
+#endif
+    tried += (tried.empty() ? "" : ", ") + candidate;
+  }
+
+  error = "Failed to load the NDI(tm) library (" + reason + "). Tried " + tried +
+    ". Install the NDI(tm) runtime or set its path with GRANDIOSE_NDI_LIBRARY.";
+  return nullptr;
+}
+
+#else // GRANDIOSE_NDI_STATIC
+
+static ndiLoadFn openLibrary(std::string&) {
+  loadedPath = "(linked)";
+  return NDIlib_v5_load;
+}
+
+#endif // GRANDIOSE_NDI_STATIC
+
+// Callers hold ndiLock
+static const NDIlib_v5* openTable(std::string& error) {
+  if (opened != nullptr) return opened;
+  ndiLoadFn load = openLibrary(error);
+  if (load == nullptr) return nullptr;
+  opened = load();
+  if (opened == nullptr)
+    error = "The NDI(tm) library at " + loadedPath + " did not provide its function table.";
+  return opened;
+}
+
+const NDIlib_v5* openNdi(std::string& error) {
+  if (ndiLoaded.load(std::memory_order_acquire)) return ndiLib;
+  std::lock_guard<std::mutex> guard(ndiLock);
+  return openTable(error);
+}
+
+bool loadNdi(std::string& error) {
+  if (ndiLoaded.load(std::memory_order_acquire)) return true;
+  std::lock_guard<std::mutex> guard(ndiLock);
+  if (ndiLoaded.load(std::memory_order_relaxed)) return true;
+
+  const NDIlib_v5* table = openTable(error);
+  if (table == nullptr) return false;
+  // Not required, but "correct" (see the SDK documentation)
+  if (!table->initialize()) {
+    error = "The NDI(tm) library at " + loadedPath +
+      " failed to initialize. Is this CPU supported?";
+    return false;
+  }
+
+  LOG_INFO("Loaded NDI(tm) library %s, version %s.", loadedPath.c_str(), table->version());
+  ndiLib = table;
+  ndiLoaded.store(true, std::memory_order_release);
+  return true;
+}
+
+// Sets where the library is loaded from, or with null goes back to searching
+// for it. Throws if a different library has already been loaded.
+napi_value setLibraryPath(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  CHECK_STATUS;
+
+  napi_valuetype type = napi_undefined;
+  if (argc >= 1) {
+    status = napi_typeof(env, args[0], &type);
+    CHECK_STATUS;
+  }
+  if (type != napi_string && type != napi_null && type != napi_undefined)
+    NAPI_THROW_ERROR("Library path must be a string or null.");
+
+  std::string path;
+  if (type == napi_string) {
+    size_t length;
+    status = napi_get_value_string_utf8(env, args[0], nullptr, 0, &length);
+    CHECK_STATUS;
+    path.resize(length + 1);
+    status = napi_get_value_string_utf8(env, args[0], &path[0], length + 1, nullptr);
+    CHECK_STATUS;
+    path.resize(length);
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(ndiLock);
+    if (opened != nullptr && !path.empty() && path != loadedPath) {
+      std::string message = "The NDI(tm) library has already been loaded from " + loadedPath + ".";
+      napi_throw_error(env, nullptr, message.c_str());
+      return nullptr;
+    }
+    configuredPath = path;
+  }
+
+  napi_value result;
+  status = napi_get_undefined(env, &result);
+  CHECK_STATUS;
+  return result;
+}
@@ -0,0 +1,52 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_NDI_H
+#define GRANDIOSE_NDI_H
+
+#include <string>
+#include <Processing.NDI.Lib.h>
+#include "node_api.h"
+
+// grandiose is not linked against libndi. The library is opened the first
+// time something needs it, and all calls go through the NDIlib_v5 function
+// table that it returns, so requiring the module costs nothing until a
+// finder, sender, receiver or router is made. The library is looked for:
+//
+//  1. at the path given to setLibraryPath() or in GRANDIOSE_NDI_LIBRARY, and
+//     only there if either is set;
+//  2. in the NDI runtime folder named by the NDI_RUNTIME_DIR_V5 variable;
+//  3. in the lib folder of the package, as installed;
+//  4. on the system's library search path.
+//
+// Any library exporting NDIlib_v5_load() will do, such as mock/ndi_mock.cc.
+// Builds defining GRANDIOSE_NDI_STATIC use the one they are linked with.
+
+// The loaded function table, set once by loadNdi() and never unloaded. Only
+// valid on paths that follow a successful loadNdi(), such as any that use an
+// NDI instance.
+extern const NDIlib_v5* ndiLib;
+
+// Opens and initializes the library if that has not been done. May be called
+// from any thread. Returns false with the reason in error if it fails.
+bool loadNdi(std::string& error);
+
+// Opens the library without initializing it, for version() and
+// isSupportedCPU(), which work whether or not the CPU is supported
+const NDIlib_v5* openNdi(std::string& error);
+
+napi_value setLibraryPath(napi_env env, napi_callback_info info);
+
+#endif /* GRANDIOSE_NDI_H */
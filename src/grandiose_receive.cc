@@ -14,30 +14,356 @@
 */
 
 #include <chrono>
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <Processing.NDI.Lib.h>
 #include <inttypes.h>
 
-#ifdef _WIN32
-#ifdef _WIN64
-#pragma comment(lib, "Processing.NDI.Lib.x64.lib")
-#else // _WIN64
-#pragma comment(lib, "Processing.NDI.Lib.x86.lib")
-#endif // _WIN64
-#endif // _WIN32
-
 #include "grandiose_receive.h"
+#include "grandiose_receiver.h"
 #include "grandiose_util.h"
+#include "grandiose_trace.h"
+#include "grandiose_metrics.h"
+
+receiverState *retainReceiver(receiverState *r)
+{
+  r->refCount.fetch_add(1, std::memory_order_relaxed);
+  return r;
+}
+
+// Converted audio blocks carry their capacity in a header ahead of the data
+#define AUDIO_BLOCK_ALIGNMENT 64
+#define AUDIO_BLOCK_SPARES 8
+#define RECEIVER_SPARE_CARRIERS 8
+
+void *acquireAudioBlock(receiverState *r, size_t size)
+{
+  char *block = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(r->audioLock);
+    if (!r->audioBlocks.empty())
+    {
+      block = (char *)r->audioBlocks.back();
+      r->audioBlocks.pop_back();
+    }
+  }
+
+  if (block != nullptr && *(size_t *)block < size)
+  {
+    alignedFree(block);
+    block = nullptr;
+  }
+  if (block == nullptr)
+  {
+    block = (char *)alignedAlloc(size + AUDIO_BLOCK_ALIGNMENT, AUDIO_BLOCK_ALIGNMENT);
+    if (block == nullptr)
+      return nullptr;
+    *(size_t *)block = size;
+  }
+  return block + AUDIO_BLOCK_ALIGNMENT;
+}
+
+size_t audioBlockCapacity(void *data)
+{
+  return *(size_t *)((char *)data - AUDIO_BLOCK_ALIGNMENT);
+}
+
+void recycleAudioBlock(receiverState *r, void *data)
+{
+  char *block = (char *)data - AUDIO_BLOCK_ALIGNMENT;
+  {
+    std::lock_guard<std::mutex> guard(r->audioLock);
+    if (r->audioBlocks.size() < AUDIO_BLOCK_SPARES)
+    {
+      r->audioBlocks.push_back(block);
+      return;
+    }
+  }
+  alignedFree(block);
+}
+
+dataCarrier *acquireDataCarrier(receiverState *r)
+{
+  dataCarrier *c = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(r->carrierLock);
+    if (!r->spareCarriers.empty())
+    {
+      c = r->spareCarriers.back();
+      r->spareCarriers.pop_back();
+    }
+  }
+  if (c == nullptr)
+  {
+    c = new dataCarrier;
+    metrics.carriersAllocated.fetch_add(1, std::memory_order_relaxed);
+  }
+  bindReceiver(c, r);
+  return c;
+}
+
+// Spare carriers are reset as they are put back, so hold no frames and no
+// reference to the receiver that keeps them
+void recycleDataCarrier(dataCarrier *c)
+{
+  receiverState *r = c->receiver;
+  if (r == nullptr)
+  {
+    delete c;
+    return;
+  }
+
+  releaseFrames(c);
+  c->receiver = nullptr;
+  *c = dataCarrier();
+
+  bool kept = false;
+  {
+    std::lock_guard<std::mutex> guard(r->carrierLock);
+    if (r->spareCarriers.size() < RECEIVER_SPARE_CARRIERS)
+    {
+      r->spareCarriers.push_back(c);
+      kept = true;
+    }
+  }
+  if (!kept)
+    delete c;
+  releaseReceiver(r);
+}
+
+void releaseReceiver(receiverState *r)
+{
+  if (r->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    LOG_DEBUG("Releasing receiver.");
+    untrackReceiver(r);
+    ndiLib->recv_destroy(r->recv);
+    for (void *block : r->audioBlocks)
+      alignedFree(block);
+    for (dataCarrier *c : r->spareCarriers)
+      delete c;
+    delete r;
+  }
+}
+
+NDIlib_frame_type_e captureFrame(receiverState *r, NDIlib_video_frame_v2_t *video,
+                                 NDIlib_audio_frame_v3_t *audio, NDIlib_metadata_frame_t *metadata, uint32_t wait)
+{
+  HR_TIME_POINT start = NOW;
+  NDIlib_frame_type_e frameType = ndiLib->recv_capture_v3(r->recv, video, audio, metadata, wait);
+  r->counters.captureTime.fetch_add(microTime(start), std::memory_order_relaxed);
+  r->counters.captures.fetch_add(1, std::memory_order_relaxed);
+  metrics.captures.fetch_add(1, std::memory_order_relaxed);
+  switch (frameType)
+  {
+  case NDIlib_frame_type_none:
+    r->counters.timeouts.fetch_add(1, std::memory_order_relaxed);
+    metrics.timeouts.fetch_add(1, std::memory_order_relaxed);
+    break;
+  case NDIlib_frame_type_video:
+    countFrame(metrics.framesReceived, metrics.bytesReceived, METRIC_VIDEO, videoFrameBytes(*video));
+    break;
+  case NDIlib_frame_type_audio:
+    countFrame(metrics.framesReceived, metrics.bytesReceived, METRIC_AUDIO, audioFrameBytes(*audio));
+    break;
+  case NDIlib_frame_type_metadata:
+    countFrame(metrics.framesReceived, metrics.bytesReceived, METRIC_METADATA, metadataFrameBytes(*metadata));
+    break;
+  default:
+    break;
+  }
+  return frameType;
+}
+
+void recordCompletion(receiverState *r, HR_TIME_POINT start)
+{
+  r->counters.completionTime.fetch_add(microTime(start), std::memory_order_relaxed);
+  r->counters.completions.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Latencies of video or audio frames for a receiver
+frameLatency &receiverLatency(receiverState *r, NDIlib_frame_type_e type)
+{
+  return type == NDIlib_frame_type_video ? r->videoLatency : r->audioLatency;
+}
+
+// Note when a frame was captured, and how long after NDI timestamped it
+void recordCapture(dataCarrier *c, NDIlib_frame_type_e type, int64_t timestamp)
+{
+  c->captured = NOW;
+  if (timestamp == NDIlib_recv_timestamp_undefined || timestamp <= 0)
+    return;
+  int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+  // Timestamps are in 100ns units, and may be ahead of a skewed local clock
+  if (now >= timestamp * 100)
+  {
+    receiverLatency(c->receiver, type).ndi.record((uint64_t)(now - timestamp * 100));
+    metrics.receiveNdiLatency[metricIndex(type)].record((uint64_t)(now - timestamp * 100));
+  }
+}
 
-void finalizeReceive(napi_env env, void *data, void *hint)
+// Record the latencies of a frame once its promise has been resolved
+void recordResolved(dataCarrier *c, NDIlib_frame_type_e type, HR_TIME_POINT completeStart)
 {
-  printf("Releasing receiver.\n");
-  NDIlib_recv_destroy((NDIlib_recv_instance_t)data);
+  frameLatency &latency = receiverLatency(c->receiver, type);
+  latency.queue.record(std::chrono::duration_cast<std::chrono::nanoseconds>(completeStart - c->captured).count());
+  latency.complete.recordSince(completeStart);
+  latency.total.recordSince(c->captured);
+  metrics.receiveLatency[metricIndex(type)].recordSince(c->captured);
+}
+
+// Hold a reference to the native receiver until the carrier is tidied
+void bindReceiver(dataCarrier *c, receiverState *receiver)
+{
+  c->receiver = retainReceiver(receiver);
+  c->recv = receiver->recv;
+}
+
+// Video frames handed to JavaScript without copying hold on to the NDI frame
+// and its receiver until the buffer is garbage collected.
+struct zeroCopyVideoFrame
+{
+  receiverState *receiver;
+  NDIlib_video_frame_v2_t frame;
+  size_t length;
+};
+
+void finalizeZeroCopyVideo(napi_env env, void *data, void *hint)
+{
+  zeroCopyVideoFrame *z = (zeroCopyVideoFrame *)hint;
+  int64_t adjusted;
+  napi_adjust_external_memory(env, -(int64_t)z->length, &adjusted);
+  ndiLib->recv_free_video_v2(z->receiver->recv, &z->frame);
+  releaseReceiver(z->receiver);
+  delete z;
+}
+
+// Converted audio handed to JavaScript goes back to its receiver's blocks
+// when the buffer is garbage collected.
+void finalizeAudioBlock(napi_env env, void *data, void *hint)
+{
+  receiverState *receiver = (receiverState *)hint;
+  int64_t adjusted;
+  napi_adjust_external_memory(env, -(int64_t)audioBlockCapacity(data), &adjusted);
+  recycleAudioBlock(receiver, data);
+  releaseReceiver(receiver);
+}
+
+// Release any NDI frames and audio blocks still held by a carrier. Safe to call
+// repeatedly.
+void releaseFrames(dataCarrier *c)
+{
+  if (c->videoFrame.p_data != nullptr)
+  {
+    ndiLib->recv_free_video_v2(c->recv, &c->videoFrame);
+    c->videoFrame.p_data = nullptr;
+  }
+  if (c->audioFrame.p_data != nullptr)
+  {
+    ndiLib->recv_free_audio_v3(c->recv, &c->audioFrame);
+    c->audioFrame.p_data = nullptr;
+  }
+  if (c->metadataFrame.p_data != nullptr)
+  {
+    ndiLib->recv_free_metadata(c->recv, &c->metadataFrame);
+    c->metadataFrame.p_data = nullptr;
+  }
+  if (c->audioFrame16s.p_data != nullptr)
+  {
+    recycleAudioBlock(c->receiver, c->audioFrame16s.p_data);
+    c->audioFrame16s.p_data = nullptr;
+  }
+  if (c->audioFrame32fIlvd.p_data != nullptr)
+  {
+    recycleAudioBlock(c->receiver, c->audioFrame32fIlvd.p_data);
+    c->audioFrame32fIlvd.p_data = nullptr;
+  }
+  if (c->audioPlanar != nullptr)
+  {
+    recycleAudioBlock(c->receiver, c->audioPlanar);
+    c->audioPlanar = nullptr;
+  }
+}
+
+// Number of bytes of audio data handed to JavaScript for a captured frame
+size_t audioDataLength(dataCarrier *c)
+{
+  int32_t factor = (c->audioFormat == Grandiose_audio_format_int_16_interleaved) ? 2 : 1;
+  return (size_t)(c->audioFrame.channel_stride_in_bytes / factor) * c->audioFrame.no_channels;
+}
+
+// Planar float v3 frames share the layout of v2 frames, so the v2 utilities
+// can convert them
+NDIlib_audio_frame_v2_t planarAudioView(const NDIlib_audio_frame_v3_t &frame)
+{
+  return NDIlib_audio_frame_v2_t(frame.sample_rate, frame.no_channels, frame.no_samples,
+                                 frame.timecode, (float *)frame.p_data, frame.channel_stride_in_bytes,
+                                 frame.p_metadata, frame.timestamp);
+}
+
+// Convert a captured audio frame into the format requested, using a block from
+// the receiver rather than a fresh allocation. This runs on the capture thread,
+// so the JavaScript thread only has to hand the block over.
+void convertAudio(dataCarrier *c)
+{
+  if (c->audioFrame.FourCC != NDIlib_FourCC_audio_type_FLTP)
+  {
+    c->status = GRANDIOSE_NOT_AUDIO;
+    c->errorMsg = "Audio received in an unsupported format.";
+    return;
+  }
+
+  NDIlib_audio_frame_v2_t planar = planarAudioView(c->audioFrame);
+  size_t samples = (size_t)c->audioFrame.no_samples * c->audioFrame.no_channels;
+  switch (c->audioFormat)
+  {
+  case Grandiose_audio_format_int_16_interleaved:
+    c->audioFrame16s.reference_level = c->referenceLevel;
+    c->audioFrame16s.p_data = (short *)acquireAudioBlock(c->receiver,
+                                                        std::max(samples * sizeof(short), audioDataLength(c)));
+    if (c->audioFrame16s.p_data == nullptr)
+    {
+      c->status = GRANDIOSE_ALLOCATION_FAILURE;
+      c->errorMsg = "Failed to allocate memory for converted audio.";
+      break;
+    }
+    ndiLib->util_audio_to_interleaved_16s_v2(&planar, &c->audioFrame16s);
+    break;
+  case Grandiose_audio_format_float_32_interleaved:
+    c->audioFrame32fIlvd.p_data = (float *)acquireAudioBlock(c->receiver,
+                                                            std::max(samples * sizeof(float), audioDataLength(c)));
+    if (c->audioFrame32fIlvd.p_data == nullptr)
+    {
+      c->status = GRANDIOSE_ALLOCATION_FAILURE;
+      c->errorMsg = "Failed to allocate memory for converted audio.";
+      break;
+    }
+    ndiLib->util_audio_to_interleaved_32f_v2(&planar, &c->audioFrame32fIlvd);
+    break;
+  case Grandiose_audio_format_float_32_separate:
+  default:
+    c->audioPlanar = (float *)acquireAudioBlock(c->receiver, audioDataLength(c));
+    if (c->audioPlanar == nullptr)
+    {
+      c->status = GRANDIOSE_ALLOCATION_FAILURE;
+      c->errorMsg = "Failed to allocate memory for audio.";
+      break;
+    }
+    memcpy(c->audioPlanar, c->audioFrame.p_data, audioDataLength(c));
+    c->receiver->counters.bytesCopied.fetch_add(audioDataLength(c), std::memory_order_relaxed);
+    metrics.bytesCopied.fetch_add(audioDataLength(c), std::memory_order_relaxed);
+    break;
+  }
 }
 
 void receiveExecute(napi_env env, void *data)
 {
   receiveCarrier *c = (receiveCarrier *)data;
+  traceScope span(TRACE_RECEIVE, "receiveExecute");
+  traceFlowStart(TRACE_RECEIVE, "receive", c);
 
   NDIlib_recv_create_v3_t receiveConfig;
   receiveConfig.color_format = c->colorFormat;
@@ -45,7 +371,7 @@ void receiveExecute(napi_env env, void *data)
   receiveConfig.allow_video_fields = c->allowVideoFields;
   receiveConfig.p_ndi_recv_name = c->name;
 
-  c->recv = NDIlib_recv_create_v3(&receiveConfig);
+  c->recv = ndiLib->recv_create_v3(&receiveConfig);
   if (!c->recv)
   {
     c->status = GRANDIOSE_RECEIVE_CREATE_FAIL;
@@ -53,14 +379,16 @@ void receiveExecute(napi_env env, void *data)
     return;
   }
 
-  NDIlib_recv_connect(c->recv, c->source);
+  ndiLib->recv_connect(c->recv, c->source);
 }
 
 void receiveComplete(napi_env env, napi_status asyncStatus, void *data)
 {
   receiveCarrier *c = (receiveCarrier *)data;
+  traceScope span(TRACE_RECEIVE, "receiveComplete");
+  traceFlowEnd(TRACE_RECEIVE, "receive", c);
 
-  printf("Completing some receive creation work.\n");
+  LOG_DEBUG("Completing some receive creation work.");
 
   if (asyncStatus != napi_ok)
   {
@@ -69,86 +397,30 @@ void receiveComplete(napi_env env, napi_status asyncStatus, void *data)
   }
   REJECT_STATUS;
 
-  napi_value result;
-  c->status = napi_create_object(env, &result);
-  REJECT_STATUS;
-
-  napi_value embedded;
-  c->status = napi_create_external(env, c->recv, finalizeReceive, nullptr, &embedded);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "embedded", embedded);
-  REJECT_STATUS;
-
-  napi_value videoFn;
-  c->status = napi_create_function(env, "video", NAPI_AUTO_LENGTH, videoReceive,
-                                   nullptr, &videoFn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "video", videoFn);
-  REJECT_STATUS;
-
-  napi_value audioFn;
-  c->status = napi_create_function(env, "audio", NAPI_AUTO_LENGTH, audioReceive,
-                                   nullptr, &audioFn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "audio", audioFn);
-  REJECT_STATUS;
-
-  napi_value metadataFn;
-  c->status = napi_create_function(env, "metadata", NAPI_AUTO_LENGTH, metadataReceive,
-                                   nullptr, &metadataFn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "metadata", metadataFn);
-  REJECT_STATUS;
-
-  napi_value dataFn;
-  c->status = napi_create_function(env, "data", NAPI_AUTO_LENGTH, dataReceive,
-                                   nullptr, &dataFn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "data", dataFn);
-  REJECT_STATUS;
+  receiverState *state = new receiverState;
+  state->recv = c->recv;
+  trackReceiver(state);
+  state->colorFormat = c->colorFormat;
+  state->bandwidth = c->bandwidth;
+  state->allowVideoFields = c->allowVideoFields;
+  state->zeroCopy = c->zeroCopy;
+  state->binaryHeader = c->binaryHeader;
+  state->latest = c->latest;
+  state->sourceName = c->source->p_ndi_name;
+  if (c->source->p_url_address != nullptr)
+    state->sourceUrl = c->source->p_url_address;
+  if (c->name != nullptr)
+    state->name = c->name;
 
-  napi_value source, name, uri;
-  c->status = napi_create_string_utf8(env, c->source->p_ndi_name, NAPI_AUTO_LENGTH, &name);
-  REJECT_STATUS;
-  if (c->source->p_url_address != NULL)
+  // The receiver object takes its own reference to the native state
+  napi_value result;
+  if (newReceiver(env, state, &result) != napi_ok)
   {
-    c->status = napi_create_string_utf8(env, c->source->p_url_address, NAPI_AUTO_LENGTH, &uri);
-    REJECT_STATUS;
+    c->status = GRANDIOSE_RECEIVE_CREATE_FAIL;
+    c->errorMsg = "Failed to create receiver object.";
   }
-  c->status = napi_create_object(env, &source);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, source, "name", name);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, source, "urlAddress", uri);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "source", source);
-  REJECT_STATUS;
-
-  napi_value colorFormat;
-  c->status = napi_create_int32(env, (int32_t)c->colorFormat, &colorFormat);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "colorFormat", colorFormat);
-  REJECT_STATUS;
-
-  napi_value bandwidth;
-  c->status = napi_create_int32(env, (int32_t)c->bandwidth, &bandwidth);
+  releaseReceiver(state);
   REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "bandwidth", bandwidth);
-  REJECT_STATUS;
-
-  napi_value allowVideoFields;
-  c->status = napi_get_boolean(env, c->allowVideoFields, &allowVideoFields);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "allowVideoFields", allowVideoFields);
-  REJECT_STATUS;
-
-  if (c->name != nullptr)
-  {
-    c->status = napi_create_string_utf8(env, c->name, NAPI_AUTO_LENGTH, &name);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "name", name);
-    REJECT_STATUS;
-  }
 
   napi_status status;
   status = napi_resolve_deferred(env, c->_deferred, result);
@@ -216,6 +488,10 @@ napi_value receive(napi_env env, napi_callback_info info)
   c->status = napi_create_promise(env, &c->_deferred, &promise);
   REJECT_RETURN;
 
+  std::string error;
+  if (!loadNdi(error))
+    REJECT_ERROR_RETURN(error, GRANDIOSE_NDI_LOAD_FAIL);
+
   size_t argc = 1;
   napi_value args[1];
   c->status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
@@ -237,7 +513,7 @@ napi_value receive(napi_env env, napi_callback_info info)
         GRANDIOSE_INVALID_ARGS);
 
   napi_value config = args[0];
-  napi_value source, colorFormat, bandwidth, allowVideoFields, name;
+  napi_value source, colorFormat, bandwidth, allowVideoFields, zeroCopy, binaryHeader, latest, name;
   // source is an object, not an array, with name and urlAddress
   // convert to a native source
   c->status = napi_get_named_property(env, config, "source", &source);
@@ -331,6 +607,48 @@ napi_value receive(napi_env env, napi_callback_info info)
     REJECT_RETURN;
   }
 
+  c->status = napi_get_named_property(env, config, "zeroCopy", &zeroCopy);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, zeroCopy, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined)
+  {
+    if (type != napi_boolean)
+      REJECT_ERROR_RETURN(
+          "Zero copy property must be a Boolean.",
+          GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_bool(env, zeroCopy, &c->zeroCopy);
+    REJECT_RETURN;
+  }
+
+  c->status = napi_get_named_property(env, config, "binaryHeader", &binaryHeader);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, binaryHeader, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined)
+  {
+    if (type != napi_boolean)
+      REJECT_ERROR_RETURN(
+          "Binary header property must be a Boolean.",
+          GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_bool(env, binaryHeader, &c->binaryHeader);
+    REJECT_RETURN;
+  }
+
+  c->status = napi_get_named_property(env, config, "latest", &latest);
+  REJECT_RETURN;
+  c->status = napi_typeof(env, latest, &type);
+  REJECT_RETURN;
+  if (type != napi_undefined)
+  {
+    if (type != napi_boolean)
+      REJECT_ERROR_RETURN(
+          "Latest property must be a Boolean.",
+          GRANDIOSE_INVALID_ARGS);
+    c->status = napi_get_value_bool(env, latest, &c->latest);
+    REJECT_RETURN;
+  }
+
   c->status = napi_get_named_property(env, config, "name", &name);
   REJECT_RETURN;
   c->status = napi_typeof(env, name, &type);
@@ -348,27 +666,42 @@ napi_value receive(napi_env env, napi_callback_info info)
     REJECT_RETURN;
   }
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "Receive", NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, receiveExecute,
-                                     receiveComplete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  c->status = queueWork(env, c, receiveExecute, receiveComplete, c);
   REJECT_RETURN;
 
   return promise;
 }
 
+// Drain the video frames queued behind the one just captured, keeping only the
+// newest. Skipped frames are released without being copied.
+void skipToLatestVideo(dataCarrier *c)
+{
+  NDIlib_recv_queue_t queue;
+  ndiLib->recv_get_queue(c->recv, &queue);
+  for (int queued = queue.video_frames; queued > 0; queued--)
+  {
+    NDIlib_video_frame_v2_t next;
+    if (ndiLib->recv_capture_v2(c->recv, &next, nullptr, nullptr, 0) != NDIlib_frame_type_video)
+      break;
+    ndiLib->recv_free_video_v2(c->recv, &c->videoFrame);
+    c->videoFrame = next;
+    c->skipped++;
+    c->receiver->counters.skipped.fetch_add(1, std::memory_order_relaxed);
+    metrics.skipped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
 void videoReceiveExecute(napi_env env, void *data)
 {
   dataCarrier *c = (dataCarrier *)data;
+  traceScope span(TRACE_RECEIVE, "videoReceiveExecute");
+  traceFlowStart(TRACE_RECEIVE, "videoReceive", c);
 
-  auto res = NDIlib_recv_capture_v2(c->recv, &c->videoFrame, nullptr, nullptr, c->wait);
+  auto res = captureFrame(c->receiver, &c->videoFrame, nullptr, nullptr, c->wait);
   switch (res)
   {
   case NDIlib_frame_type_none:
-    printf("No data received.\n");
+    LOG_DEBUG("No data received.");
     c->status = GRANDIOSE_NOT_FOUND;
     c->errorMsg = "No video data received in the requested time interval.";
     break;
@@ -377,6 +710,9 @@ void videoReceiveExecute(napi_env env, void *data)
   case NDIlib_frame_type_video:
     /* printf("Video data %i received (%dx%d at %d/%d).\n", &c->videoFrame, c->videoFrame.xres, c->videoFrame.yres,
       c->videoFrame.frame_rate_N, c->videoFrame.frame_rate_D); */
+    if (c->receiver->latest)
+      skipToLatestVideo(c);
+    recordCapture(c, NDIlib_frame_type_video, c->videoFrame.timestamp);
     break;
 
   case NDIlib_frame_type_error:
@@ -386,16 +722,244 @@ void videoReceiveExecute(napi_env env, void *data)
     break;
 
   default:
-    printf("Other kind of data received (%d).\n", res);
+    LOG_INFO("Other kind of data received (%d).", res);
     c->status = GRANDIOSE_NOT_VIDEO;
     c->errorMsg = "Non-video data received on video capture.";
     break;
   }
 }
 
+// Build a video frame object with everything but its data
+napi_status videoFramePropertiesToJs(napi_env env, const NDIlib_video_frame_v2_t &frame, napi_value *result)
+{
+  napi_status status;
+  status = napi_create_object(env, result);
+  PASS_STATUS;
+
+  int32_t ptps, ptpn;
+  ptps = (int32_t)(frame.timestamp / 10000000);
+  ptpn = (frame.timestamp % 10000000) * 100;
+
+  napi_value param;
+  status = napi_create_string_utf8(env, "video", NAPI_AUTO_LENGTH, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "type", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, frame.xres, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "xres", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, frame.yres, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "yres", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, frame.frame_rate_N, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "frameRateN", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, frame.frame_rate_D, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "frameRateD", param);
+  PASS_STATUS;
+
+  status = napi_create_double(env, (double)frame.picture_aspect_ratio, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "pictureAspectRatio", param);
+  PASS_STATUS;
+
+  napi_value params, paramn;
+  status = napi_create_int32(env, ptps, &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, ptpn, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "timestamp", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, frame.FourCC, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "fourCC", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, frame.frame_format_type, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "frameFormatType", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, (int32_t)frame.timecode / 10000000, &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, (frame.timecode % 10000000) * 100, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "timecode", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, frame.line_stride_in_bytes, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "lineStrideBytes", param);
+  PASS_STATUS;
+
+  if (frame.p_metadata != nullptr)
+  {
+    status = napi_create_string_utf8(env, frame.p_metadata, NAPI_AUTO_LENGTH, &param);
+    PASS_STATUS;
+    status = napi_set_named_property(env, *result, "metadata", param);
+    PASS_STATUS;
+  }
+
+  return napi_ok;
+}
+
+// Binary frame headers are written straight into an ArrayBuffer, with the
+// fields read back lazily by the frame classes registered from index.js.
+static_assert(sizeof(videoFrameHeader) == 48, "Video frame header layout must match index.js");
+static_assert(sizeof(audioFrameHeader) == 40, "Audio frame header layout must match index.js");
+
+napi_status videoFrameHeaderToJs(napi_env env, const NDIlib_video_frame_v2_t &frame, napi_value *result)
+{
+  napi_status status;
+  void *data;
+  status = napi_create_arraybuffer(env, sizeof(videoFrameHeader), &data, result);
+  PASS_STATUS;
+
+  videoFrameHeader *header = (videoFrameHeader *)data;
+  header->xres = frame.xres;
+  header->yres = frame.yres;
+  header->frameRateN = frame.frame_rate_N;
+  header->frameRateD = frame.frame_rate_D;
+  header->pictureAspectRatio = frame.picture_aspect_ratio;
+  header->frameFormatType = frame.frame_format_type;
+  header->fourCC = frame.FourCC;
+  header->lineStrideBytes = frame.line_stride_in_bytes;
+  header->timestamp = frame.timestamp;
+  header->timecode = frame.timecode;
+  return napi_ok;
+}
+
+napi_status audioFrameHeaderToJs(napi_env env, const NDIlib_audio_frame_v3_t &frame,
+                                 Grandiose_audio_format_e audioFormat, int32_t referenceLevel, napi_value *result)
+{
+  napi_status status;
+  void *data;
+  status = napi_create_arraybuffer(env, sizeof(audioFrameHeader), &data, result);
+  PASS_STATUS;
+
+  int32_t factor = (audioFormat == Grandiose_audio_format_int_16_interleaved) ? 2 : 1;
+  audioFrameHeader *header = (audioFrameHeader *)data;
+  header->sampleRate = frame.sample_rate;
+  header->channels = frame.no_channels;
+  header->samples = frame.no_samples;
+  header->channelStrideInBytes = frame.channel_stride_in_bytes / factor;
+  header->audioFormat = audioFormat;
+  header->referenceLevel = referenceLevel;
+  header->timestamp = frame.timestamp;
+  header->timecode = frame.timecode;
+  return napi_ok;
+}
+
+// The registered class for binary header frames of a type, or nullptr
+napi_value frameConstructor(napi_env env, NDIlib_frame_type_e type)
+{
+  GrandioseInstanceData *instance;
+  if (napi_get_instance_data(env, (void **)&instance) != napi_ok || instance == nullptr)
+    return nullptr;
+
+  Napi::FunctionReference &constructor =
+      (type == NDIlib_frame_type_video) ? instance->videoFrame : instance->audioFrame;
+  if (constructor.IsEmpty())
+    return nullptr;
+  return constructor.Value();
+}
+
+napi_status frameMetadataToJs(napi_env env, const char *metadata, napi_value *result)
+{
+  if (metadata == nullptr)
+    return napi_get_undefined(env, result);
+  return napi_create_string_utf8(env, metadata, NAPI_AUTO_LENGTH, result);
+}
+
+napi_status videoFrameToJs(napi_env env, dataCarrier *c, napi_value *result)
+{
+  napi_status status;
+  HR_TIME_POINT start = NOW;
+  napi_value constructor = c->receiver->binaryHeader ? frameConstructor(env, NDIlib_frame_type_video) : nullptr;
+  napi_value header, metadata;
+  if (constructor != nullptr)
+  {
+    status = videoFrameHeaderToJs(env, c->videoFrame, &header);
+    PASS_STATUS;
+    status = frameMetadataToJs(env, c->videoFrame.p_metadata, &metadata);
+  }
+  else
+  {
+    status = videoFramePropertiesToJs(env, c->videoFrame, result);
+  }
+  PASS_STATUS;
+
+  napi_value param;
+  size_t length = (size_t)c->videoFrame.line_stride_in_bytes * c->videoFrame.yres;
+  status = napi_no_external_buffers_allowed;
+  if (c->receiver->zeroCopy)
+  {
+    zeroCopyVideoFrame *z = new zeroCopyVideoFrame{c->receiver, c->videoFrame, length};
+    status = napi_create_external_buffer(env, length, (void *)c->videoFrame.p_data,
+                                         finalizeZeroCopyVideo, z, &param);
+    if (status == napi_ok)
+    {
+      // The frame now belongs to the buffer, which also keeps the receiver alive
+      retainReceiver(c->receiver);
+      c->videoFrame.p_data = nullptr;
+      int64_t adjusted;
+      napi_adjust_external_memory(env, (int64_t)length, &adjusted);
+    }
+    else
+    {
+      delete z;
+    }
+  }
+  // Runtimes such as Electron may forbid external buffers, so fall back to copying
+  if (status == napi_no_external_buffers_allowed)
+  {
+    status = napi_create_buffer_copy(env, length,
+                                     (void *)c->videoFrame.p_data, nullptr, &param);
+    if (status == napi_ok)
+    {
+      c->receiver->counters.bytesCopied.fetch_add(length, std::memory_order_relaxed);
+      metrics.bytesCopied.fetch_add(length, std::memory_order_relaxed);
+    }
+  }
+  PASS_STATUS;
+
+  releaseFrames(c);
+  recordCompletion(c->receiver, start);
+  if (constructor != nullptr)
+  {
+    napi_value args[3] = {header, param, metadata};
+    return napi_new_instance(env, constructor, 3, args, result);
+  }
+  return napi_set_named_property(env, *result, "data", param);
+}
+
 void videoReceiveComplete(napi_env env, napi_status asyncStatus, void *data)
 {
   dataCarrier *c = (dataCarrier *)data;
+  traceScope span(TRACE_RECEIVE, "videoReceiveComplete");
+  traceFlowEnd(TRACE_RECEIVE, "videoReceive", c);
+  HR_TIME_POINT completeStart = NOW;
 
   if (asyncStatus != napi_ok)
   {
@@ -405,114 +969,30 @@ void videoReceiveComplete(napi_env env, napi_status asyncStatus, void *data)
   REJECT_STATUS;
 
   napi_value result;
-  c->status = napi_create_object(env, &result);
-  REJECT_STATUS;
-
-  int32_t ptps, ptpn;
-  ptps = (int32_t)(c->videoFrame.timestamp / 10000000);
-  ptpn = (c->videoFrame.timestamp % 10000000) * 100;
-
-  napi_value param;
-  c->status = napi_create_string_utf8(env, "video", NAPI_AUTO_LENGTH, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "type", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, c->videoFrame.xres, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "xres", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, c->videoFrame.yres, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "yres", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, c->videoFrame.frame_rate_N, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "frameRateN", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, c->videoFrame.frame_rate_D, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "frameRateD", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_double(env, (double)c->videoFrame.picture_aspect_ratio, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "pictureAspectRatio", param);
-  REJECT_STATUS;
-
-  napi_value params, paramn;
-  c->status = napi_create_int32(env, ptps, &params);
-  REJECT_STATUS;
-  c->status = napi_create_int32(env, ptpn, &paramn);
-  REJECT_STATUS;
-  c->status = napi_create_array(env, &param);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 0, params);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 1, paramn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "timestamp", param);
+  c->status = videoFrameToJs(env, c, &result);
   REJECT_STATUS;
 
-  c->status = napi_create_int32(env, c->videoFrame.FourCC, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "fourCC", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, c->videoFrame.frame_format_type, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "frameFormatType", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, (int32_t)c->videoFrame.timecode / 10000000, &params);
-  REJECT_STATUS;
-  c->status = napi_create_int32(env, (c->videoFrame.timecode % 10000000) * 100, &paramn);
-  REJECT_STATUS;
-  c->status = napi_create_array(env, &param);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 0, params);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 1, paramn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "timecode", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, c->videoFrame.line_stride_in_bytes, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "lineStrideBytes", param);
-  REJECT_STATUS;
-
-  if (c->videoFrame.p_metadata != nullptr)
+  if (c->receiver->latest)
   {
-    c->status = napi_create_string_utf8(env, c->videoFrame.p_metadata, NAPI_AUTO_LENGTH, &param);
+    napi_value skipped;
+    c->status = napi_create_uint32(env, c->skipped, &skipped);
     REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "metadata", param);
+    c->status = napi_set_named_property(env, result, "skipped", skipped);
     REJECT_STATUS;
   }
 
-  c->status = napi_create_buffer_copy(env,
-                                      c->videoFrame.line_stride_in_bytes * c->videoFrame.yres,
-                                      (void *)c->videoFrame.p_data, nullptr, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "data", param);
-  REJECT_STATUS;
-
-  NDIlib_recv_free_video_v2(c->recv, &c->videoFrame);
-
   napi_status status;
   status = napi_resolve_deferred(env, c->_deferred, result);
   FLOATING_STATUS;
+  recordResolved(c, NDIlib_frame_type_video, completeStart);
 
   tidyCarrier(env, c);
 }
 
-napi_value videoReceive(napi_env env, napi_callback_info info)
+napi_value videoReceive(napi_env env, napi_callback_info info, receiverState *receiver)
 {
   napi_valuetype type;
-  dataCarrier *c = new dataCarrier;
+  dataCarrier *c = acquireDataCarrier(receiver);
 
   napi_value promise;
   c->status = napi_create_promise(env, &c->_deferred, &promise);
@@ -520,16 +1000,7 @@ napi_value videoReceive(napi_env env, napi_callback_info info)
 
   size_t argc = 1;
   napi_value args[1];
-  napi_value thisValue;
-  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-  REJECT_RETURN;
-
-  napi_value recvValue;
-  c->status = napi_get_named_property(env, thisValue, "embedded", &recvValue);
-  REJECT_RETURN;
-  void *recvData;
-  c->status = napi_get_value_external(env, recvValue, &recvData);
-  c->recv = (NDIlib_recv_instance_t)recvData;
+  c->status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
   REJECT_RETURN;
 
   if (argc >= 1)
@@ -543,13 +1014,7 @@ napi_value videoReceive(napi_env env, napi_callback_info info)
     }
   }
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "VideoReceive", NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, videoReceiveExecute,
-                                     videoReceiveComplete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  c->status = queueWork(env, c, videoReceiveExecute, videoReceiveComplete, c);
   REJECT_RETURN;
 
   return promise;
@@ -558,178 +1023,263 @@ napi_value videoReceive(napi_env env, napi_callback_info info)
 void audioReceiveExecute(napi_env env, void *data)
 {
   dataCarrier *c = (dataCarrier *)data;
+  traceScope span(TRACE_RECEIVE, "audioReceiveExecute");
+  traceFlowStart(TRACE_RECEIVE, "audioReceive", c);
 
-  switch (NDIlib_recv_capture_v2(c->recv, nullptr, &c->audioFrame, nullptr, c->wait))
+  switch (captureFrame(c->receiver, nullptr, &c->audioFrame, nullptr, c->wait))
   {
   case NDIlib_frame_type_none:
-    printf("No data received.\n");
+    LOG_DEBUG("No data received.");
     c->status = GRANDIOSE_NOT_FOUND;
     c->errorMsg = "No audio data received in the requested time interval.";
     break;
 
   // Audio data
   case NDIlib_frame_type_audio:
-    switch (c->audioFormat)
-    {
-    case Grandiose_audio_format_int_16_interleaved:
-      c->audioFrame16s.reference_level = c->referenceLevel;
-      c->audioFrame16s.p_data = new short[c->audioFrame.no_samples * c->audioFrame.no_channels];
-      NDIlib_util_audio_to_interleaved_16s_v2(&c->audioFrame, &c->audioFrame16s);
-      break;
-    case Grandiose_audio_format_float_32_interleaved:
-      c->audioFrame32fIlvd.p_data = new float[c->audioFrame.no_samples * c->audioFrame.no_channels];
-      NDIlib_util_audio_to_interleaved_32f_v2(&c->audioFrame, &c->audioFrame32fIlvd);
-      break;
-    case Grandiose_audio_format_float_32_separate:
-    default:
-      c->status = GRANDIOSE_NOT_AUDIO;
-      c->errorMsg = "Non-audio data received on audio capture.";
-      break;
-    }
+    recordCapture(c, NDIlib_frame_type_audio, c->audioFrame.timestamp);
+    convertAudio(c);
     break;
 
   default:
-    printf("Other kind of data received.\n");
+    LOG_INFO("Other kind of data received.");
     c->status = GRANDIOSE_NOT_AUDIO;
     c->errorMsg = "Non-audio data received on audio capture.";
     break;
   }
 }
 
-void audioReceiveComplete(napi_env env, napi_status asyncStatus, void *data)
+// Build an audio frame object with everything but its data
+napi_status audioFramePropertiesToJs(napi_env env, const NDIlib_audio_frame_v3_t &frame,
+                                     Grandiose_audio_format_e audioFormat, int32_t referenceLevel, napi_value *result)
 {
-  dataCarrier *c = (dataCarrier *)data;
-
-  // printf("Audio receiver completing - status %i.\n", c->status);
-
-  if (asyncStatus != napi_ok)
-  {
-    c->status = asyncStatus;
-    c->errorMsg = "Async audio frame receive failed to complete.";
-  }
-  REJECT_STATUS;
-
-  napi_value result;
-  c->status = napi_create_object(env, &result);
-  REJECT_STATUS;
+  napi_status status;
+  status = napi_create_object(env, result);
+  PASS_STATUS;
 
   int32_t ptps, ptpn;
-  ptps = (int32_t)(c->audioFrame.timestamp / 10000000);
-  ptpn = (c->audioFrame.timestamp % 10000000) * 100;
+  ptps = (int32_t)(frame.timestamp / 10000000);
+  ptpn = (frame.timestamp % 10000000) * 100;
 
   napi_value param;
-  c->status = napi_create_string_utf8(env, "audio", NAPI_AUTO_LENGTH, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "type", param);
-  REJECT_STATUS;
+  status = napi_create_string_utf8(env, "audio", NAPI_AUTO_LENGTH, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "type", param);
+  PASS_STATUS;
 
-  c->status = napi_create_int32(env, c->audioFormat, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "audioFormat", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, audioFormat, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "audioFormat", param);
+  PASS_STATUS;
 
-  if (c->audioFormat == Grandiose_audio_format_int_16_interleaved)
+  if (audioFormat == Grandiose_audio_format_int_16_interleaved)
   {
-    c->status = napi_create_int32(env, c->referenceLevel, &param);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "referenceLevel", param);
-    REJECT_STATUS;
+    status = napi_create_int32(env, referenceLevel, &param);
+    PASS_STATUS;
+    status = napi_set_named_property(env, *result, "referenceLevel", param);
+    PASS_STATUS;
   }
 
-  c->status = napi_create_int32(env, c->audioFrame.sample_rate, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "sampleRate", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, frame.sample_rate, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "sampleRate", param);
+  PASS_STATUS;
 
-  c->status = napi_create_int32(env, c->audioFrame.no_channels, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "channels", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, frame.no_channels, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "channels", param);
+  PASS_STATUS;
 
-  c->status = napi_create_int32(env, c->audioFrame.no_samples, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "samples", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, frame.no_samples, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "samples", param);
+  PASS_STATUS;
 
-  int32_t factor = (c->audioFormat == Grandiose_audio_format_int_16_interleaved) ? 2 : 1;
-  c->status = napi_create_int32(env, c->audioFrame.channel_stride_in_bytes / factor, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "channelStrideInBytes", param);
-  REJECT_STATUS;
+  int32_t factor = (audioFormat == Grandiose_audio_format_int_16_interleaved) ? 2 : 1;
+  status = napi_create_int32(env, frame.channel_stride_in_bytes / factor, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "channelStrideInBytes", param);
+  PASS_STATUS;
 
   napi_value params, paramn;
-  c->status = napi_create_int32(env, ptps, &params);
-  REJECT_STATUS;
-  c->status = napi_create_int32(env, ptpn, &paramn);
-  REJECT_STATUS;
-  c->status = napi_create_array(env, &param);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 0, params);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 1, paramn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "timestamp", param);
-  REJECT_STATUS;
+  status = napi_create_int32(env, ptps, &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, ptpn, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "timestamp", param);
+  PASS_STATUS;
 
-  // printf("Timecode is %lld.\n", c->audioFrame.timecode);
-  c->status = napi_create_int32(env, (int32_t)(c->audioFrame.timecode / 10000000), &params);
-  REJECT_STATUS;
-  c->status = napi_create_int32(env, (c->audioFrame.timecode % 10000000) * 100, &paramn);
-  REJECT_STATUS;
-  c->status = napi_create_array(env, &param);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 0, params);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 1, paramn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "timecode", param);
-  REJECT_STATUS;
+  // printf("Timecode is %lld.\n", frame.timecode);
+  status = napi_create_int32(env, (int32_t)(frame.timecode / 10000000), &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, (frame.timecode % 10000000) * 100, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "timecode", param);
+  PASS_STATUS;
 
-  if (c->audioFrame.p_metadata != nullptr)
+  if (frame.p_metadata != nullptr)
   {
-    c->status = napi_create_string_utf8(env, c->audioFrame.p_metadata, NAPI_AUTO_LENGTH, &param);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "metadata", param);
-    REJECT_STATUS;
+    status = napi_create_string_utf8(env, frame.p_metadata, NAPI_AUTO_LENGTH, &param);
+    PASS_STATUS;
+    status = napi_set_named_property(env, *result, "metadata", param);
+    PASS_STATUS;
+  }
+
+  return napi_ok;
+}
+
+// Float32Array views of each channel of planar audio, over the same memory as
+// its data buffer
+napi_status planarChannelsToJs(napi_env env, napi_value buffer, int32_t channels,
+                               int32_t samples, int32_t channelStride, napi_value *result)
+{
+  napi_status status;
+  napi_typedarray_type type;
+  size_t length, offset;
+  void *data;
+  napi_value arrayBuffer;
+  status = napi_get_typedarray_info(env, buffer, &type, &length, &data, &arrayBuffer, &offset);
+  PASS_STATUS;
+
+  status = napi_create_array_with_length(env, channels, result);
+  PASS_STATUS;
+  for (int32_t i = 0; i < channels; i++)
+  {
+    napi_value channel;
+    status = napi_create_typedarray(env, napi_float32_array, samples, arrayBuffer,
+                                    offset + (size_t)i * channelStride, &channel);
+    PASS_STATUS;
+    status = napi_set_element(env, *result, i, channel);
+    PASS_STATUS;
+  }
+  return napi_ok;
+}
+
+napi_status audioFrameToJs(napi_env env, dataCarrier *c, napi_value *result)
+{
+  napi_status status;
+  HR_TIME_POINT start = NOW;
+  napi_value constructor = c->receiver->binaryHeader ? frameConstructor(env, NDIlib_frame_type_audio) : nullptr;
+  napi_value header, metadata;
+  if (constructor != nullptr)
+  {
+    status = audioFrameHeaderToJs(env, c->audioFrame, c->audioFormat, c->referenceLevel, &header);
+    PASS_STATUS;
+    status = frameMetadataToJs(env, c->audioFrame.p_metadata, &metadata);
   }
+  else
+  {
+    status = audioFramePropertiesToJs(env, c->audioFrame, c->audioFormat, c->referenceLevel, result);
+  }
+  PASS_STATUS;
 
+  napi_value param;
   char *rawFloats;
+  void **converted;
   switch (c->audioFormat)
   {
   case Grandiose_audio_format_int_16_interleaved:
+    converted = (void **)&c->audioFrame16s.p_data;
     rawFloats = (char *)c->audioFrame16s.p_data;
     break;
   case Grandiose_audio_format_float_32_interleaved:
+    converted = (void **)&c->audioFrame32fIlvd.p_data;
     rawFloats = (char *)c->audioFrame32fIlvd.p_data;
     break;
   default:
   case Grandiose_audio_format_float_32_separate:
-    rawFloats = (char *)c->audioFrame.p_data;
+    converted = (void **)&c->audioPlanar;
+    rawFloats = (char *)c->audioPlanar;
     break;
   }
-  c->status = napi_create_buffer_copy(env,
-                                      (c->audioFrame.channel_stride_in_bytes / factor) * c->audioFrame.no_channels,
-                                      rawFloats, nullptr, &param);
-  REJECT_STATUS;
+  size_t length = audioDataLength(c);
+  // Hand the converted block over to the buffer rather than copying it again
+  status = napi_create_external_buffer(env, length, rawFloats,
+                                       finalizeAudioBlock, c->receiver, &param);
+  if (status == napi_ok)
+  {
+    retainReceiver(c->receiver);
+    *converted = nullptr;
+    int64_t adjusted;
+    napi_adjust_external_memory(env, (int64_t)audioBlockCapacity(rawFloats), &adjusted);
+  }
+  if (status == napi_no_external_buffers_allowed)
+  {
+    status = napi_create_buffer_copy(env, length, rawFloats, nullptr, &param);
+    if (status == napi_ok)
+    {
+      c->receiver->counters.bytesCopied.fetch_add(length, std::memory_order_relaxed);
+      metrics.bytesCopied.fetch_add(length, std::memory_order_relaxed);
+    }
+  }
+  PASS_STATUS;
+
+  int32_t channels = c->audioFrame.no_channels;
+  int32_t samples = c->audioFrame.no_samples;
+  int32_t channelStride = c->audioFrame.channel_stride_in_bytes;
+  releaseFrames(c);
+  recordCompletion(c->receiver, start);
+  if (constructor != nullptr)
+  {
+    napi_value args[3] = {header, param, metadata};
+    return napi_new_instance(env, constructor, 3, args, result);
+  }
+  status = napi_set_named_property(env, *result, "data", param);
+  PASS_STATUS;
+
+  if (c->audioFormat == Grandiose_audio_format_float_32_separate)
+  {
+    napi_value channelData;
+    status = planarChannelsToJs(env, param, channels, samples, channelStride, &channelData);
+    PASS_STATUS;
+    status = napi_set_named_property(env, *result, "channelData", channelData);
+  }
+  return status;
+}
+
+void audioReceiveComplete(napi_env env, napi_status asyncStatus, void *data)
+{
+  dataCarrier *c = (dataCarrier *)data;
+  traceScope span(TRACE_RECEIVE, "audioReceiveComplete");
+  traceFlowEnd(TRACE_RECEIVE, "audioReceive", c);
+  HR_TIME_POINT completeStart = NOW;
 
-  c->status = napi_set_named_property(env, result, "data", param);
+  if (asyncStatus != napi_ok)
+  {
+    c->status = asyncStatus;
+    c->errorMsg = "Async audio frame receive failed to complete.";
+  }
   REJECT_STATUS;
 
-  NDIlib_recv_free_audio_v2(c->recv, &c->audioFrame);
+  napi_value result;
+  c->status = audioFrameToJs(env, c, &result);
+  REJECT_STATUS;
 
   napi_status status;
   status = napi_resolve_deferred(env, c->_deferred, result);
   FLOATING_STATUS;
+  recordResolved(c, NDIlib_frame_type_audio, completeStart);
 
   tidyCarrier(env, c);
 }
 
-napi_value dataAndAudioReceive(napi_env env, napi_callback_info info,
-                               char *resourceName, napi_async_execute_callback execute,
+napi_value dataAndAudioReceive(napi_env env, napi_callback_info info, receiverState *receiver,
+                               napi_async_execute_callback execute,
                                napi_async_complete_callback complete)
 {
   napi_valuetype type;
-  dataCarrier *c = new dataCarrier;
+  dataCarrier *c = acquireDataCarrier(receiver);
 
   napi_value promise;
   c->status = napi_create_promise(env, &c->_deferred, &promise);
@@ -737,16 +1287,7 @@ napi_value dataAndAudioReceive(napi_env env, napi_callback_info info,
 
   size_t argc = 2;
   napi_value args[2];
-  napi_value thisValue;
-  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-  REJECT_RETURN;
-
-  napi_value recvValue;
-  c->status = napi_get_named_property(env, thisValue, "embedded", &recvValue);
-  REJECT_RETURN;
-  void *recvData;
-  c->status = napi_get_value_external(env, recvValue, &recvData);
-  c->recv = (NDIlib_recv_instance_t)recvData;
+  c->status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
   REJECT_RETURN;
 
   if (argc >= 1)
@@ -809,32 +1350,28 @@ napi_value dataAndAudioReceive(napi_env env, napi_callback_info info,
     }
   }
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, resourceName, NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, execute,
-                                     complete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  c->status = queueWork(env, c, execute, complete, c);
   REJECT_RETURN;
 
   return promise;
 }
 
-napi_value audioReceive(napi_env env, napi_callback_info info)
+napi_value audioReceive(napi_env env, napi_callback_info info, receiverState *receiver)
 {
-  return dataAndAudioReceive(env, info, "AudioReceive",
+  return dataAndAudioReceive(env, info, receiver,
                              audioReceiveExecute, audioReceiveComplete);
 }
 
 void metadataReceiveExecute(napi_env env, void *data)
 {
   dataCarrier *c = (dataCarrier *)data;
+  traceScope span(TRACE_RECEIVE, "metadataReceiveExecute");
+  traceFlowStart(TRACE_RECEIVE, "metadataReceive", c);
 
-  switch (NDIlib_recv_capture_v2(c->recv, nullptr, nullptr, &c->metadataFrame, c->wait))
+  switch (captureFrame(c->receiver, nullptr, nullptr, &c->metadataFrame, c->wait))
   {
   case NDIlib_frame_type_none:
-    printf("No data received.\n");
+    LOG_DEBUG("No data received.");
     c->status = GRANDIOSE_NOT_FOUND;
     c->errorMsg = "No metadata received in the requested time interval.";
     break;
@@ -844,17 +1381,60 @@ void metadataReceiveExecute(napi_env env, void *data)
     break;
 
   default:
-    printf("Other kind of data received.\n");
+    LOG_INFO("Other kind of data received.");
     c->status = GRANDIOSE_NOT_AUDIO;
     c->errorMsg = "Non-metadata payload received on metadata capture.";
     break;
   }
 }
 
+napi_status metadataFrameToJs(napi_env env, dataCarrier *c, napi_value *result)
+{
+  napi_status status;
+  HR_TIME_POINT start = NOW;
+  status = napi_create_object(env, result);
+  PASS_STATUS;
+
+  napi_value param;
+  status = napi_create_string_utf8(env, "metadata", NAPI_AUTO_LENGTH, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "type", param);
+  PASS_STATUS;
+
+  status = napi_create_int32(env, c->metadataFrame.length, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "length", param);
+  PASS_STATUS;
+
+  napi_value params, paramn;
+  status = napi_create_int32(env, (int32_t)(c->metadataFrame.timecode / 10000000), &params);
+  PASS_STATUS;
+  status = napi_create_int32(env, (c->metadataFrame.timecode % 10000000) * 100, &paramn);
+  PASS_STATUS;
+  status = napi_create_array(env, &param);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 0, params);
+  PASS_STATUS;
+  status = napi_set_element(env, param, 1, paramn);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "timecode", param);
+  PASS_STATUS;
+
+  status = napi_create_string_utf8(env, c->metadataFrame.p_data, NAPI_AUTO_LENGTH, &param);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "data", param);
+  PASS_STATUS;
+
+  releaseFrames(c);
+  recordCompletion(c->receiver, start);
+  return napi_ok;
+}
+
 void metadataReceiveComplete(napi_env env, napi_status asyncStatus, void *data)
 {
   dataCarrier *c = (dataCarrier *)data;
-  // printf("Metadata receiver completing - status %i.\n", c->status);
+  traceScope span(TRACE_RECEIVE, "metadataReceiveComplete");
+  traceFlowEnd(TRACE_RECEIVE, "metadataReceive", c);
 
   if (asyncStatus != napi_ok)
   {
@@ -864,40 +1444,8 @@ void metadataReceiveComplete(napi_env env, napi_status asyncStatus, void *data)
   REJECT_STATUS;
 
   napi_value result;
-  c->status = napi_create_object(env, &result);
-  REJECT_STATUS;
-
-  napi_value param;
-  c->status = napi_create_string_utf8(env, "metadata", NAPI_AUTO_LENGTH, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "type", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_int32(env, c->metadataFrame.length, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "length", param);
-  REJECT_STATUS;
-
-  napi_value params, paramn;
-  c->status = napi_create_int32(env, (int32_t)(c->metadataFrame.timecode / 10000000), &params);
-  REJECT_STATUS;
-  c->status = napi_create_int32(env, (c->metadataFrame.timecode % 10000000) * 100, &paramn);
-  REJECT_STATUS;
-  c->status = napi_create_array(env, &param);
-  REJECT_STATUS;
-  c->status = napi_set_element(env, param, 0, params);
+  c->status = metadataFrameToJs(env, c, &result);
   REJECT_STATUS;
-  c->status = napi_set_element(env, param, 1, paramn);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "timecode", param);
-  REJECT_STATUS;
-
-  c->status = napi_create_string_utf8(env, c->metadataFrame.p_data, NAPI_AUTO_LENGTH, &param);
-  REJECT_STATUS;
-  c->status = napi_set_named_property(env, result, "data", param);
-  REJECT_STATUS;
-
-  NDIlib_recv_free_metadata(c->recv, &c->metadataFrame);
 
   napi_status status;
   status = napi_resolve_deferred(env, c->_deferred, result);
@@ -906,10 +1454,10 @@ void metadataReceiveComplete(napi_env env, napi_status asyncStatus, void *data)
   tidyCarrier(env, c);
 }
 
-napi_value metadataReceive(napi_env env, napi_callback_info info)
+napi_value metadataReceive(napi_env env, napi_callback_info info, receiverState *receiver)
 {
   napi_valuetype type;
-  dataCarrier *c = new dataCarrier;
+  dataCarrier *c = acquireDataCarrier(receiver);
 
   napi_value promise;
   c->status = napi_create_promise(env, &c->_deferred, &promise);
@@ -917,16 +1465,7 @@ napi_value metadataReceive(napi_env env, napi_callback_info info)
 
   size_t argc = 1;
   napi_value args[1];
-  napi_value thisValue;
-  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-  REJECT_RETURN;
-
-  napi_value recvValue;
-  c->status = napi_get_named_property(env, thisValue, "embedded", &recvValue);
-  REJECT_RETURN;
-  void *recvData;
-  c->status = napi_get_value_external(env, recvValue, &recvData);
-  c->recv = (NDIlib_recv_instance_t)recvData;
+  c->status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
   REJECT_RETURN;
 
   if (argc >= 1)
@@ -940,13 +1479,7 @@ napi_value metadataReceive(napi_env env, napi_callback_info info)
     }
   }
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "MetadataReceive", NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, metadataReceiveExecute,
-                                     metadataReceiveComplete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  c->status = queueWork(env, c, metadataReceiveExecute, metadataReceiveComplete, c);
   REJECT_RETURN;
 
   return promise;
@@ -955,28 +1488,21 @@ napi_value metadataReceive(napi_env env, napi_callback_info info)
 void dataReceiveExecute(napi_env env, void *data)
 {
   dataCarrier *c = (dataCarrier *)data;
+  traceScope span(TRACE_RECEIVE, "dataReceiveExecute");
+  traceFlowStart(TRACE_RECEIVE, "dataReceive", c);
 
-  c->frameType = NDIlib_recv_capture_v2(c->recv, &c->videoFrame, &c->audioFrame, &c->metadataFrame, c->wait);
+  c->frameType = captureFrame(c->receiver, &c->videoFrame, &c->audioFrame, &c->metadataFrame, c->wait);
   switch (c->frameType)
   {
 
+  case NDIlib_frame_type_video:
+    recordCapture(c, NDIlib_frame_type_video, c->videoFrame.timestamp);
+    break;
+
   // Audio data
   case NDIlib_frame_type_audio:
-    switch (c->audioFormat)
-    {
-    case Grandiose_audio_format_int_16_interleaved:
-      c->audioFrame16s.reference_level = c->referenceLevel;
-      c->audioFrame16s.p_data = new short[c->audioFrame.no_samples * c->audioFrame.no_channels];
-      NDIlib_util_audio_to_interleaved_16s_v2(&c->audioFrame, &c->audioFrame16s);
-      break;
-    case Grandiose_audio_format_float_32_interleaved:
-      c->audioFrame32fIlvd.p_data = new float[c->audioFrame.no_samples * c->audioFrame.no_channels];
-      NDIlib_util_audio_to_interleaved_32f_v2(&c->audioFrame, &c->audioFrame32fIlvd);
-      break;
-    case Grandiose_audio_format_float_32_separate:
-    default:
-      break;
-    }
+    recordCapture(c, NDIlib_frame_type_audio, c->audioFrame.timestamp);
+    convertAudio(c);
     break;
 
   // Handle all other types on completion
@@ -988,6 +1514,8 @@ void dataReceiveExecute(napi_env env, void *data)
 void dataReceiveComplete(napi_env env, napi_status asyncStatus, void *data)
 {
   dataCarrier *c = (dataCarrier *)data;
+  traceScope span(TRACE_RECEIVE, "dataReceiveComplete");
+  traceFlowEnd(TRACE_RECEIVE, "dataReceive", c);
 
   if (asyncStatus != napi_ok)
   {
@@ -1026,14 +1554,16 @@ void dataReceiveComplete(napi_env env, napi_status asyncStatus, void *data)
 
       tidyCarrier(env, c);
       break;
-    case NDIlib_frame_type_none:
-    case NDIlib_frame_type_max:
-      break;
+  case NDIlib_frame_type_none:
+  case NDIlib_frame_type_max:
+    c->errorMsg = "No data received in the requested time interval.";
+    c->status = GRANDIOSE_NOT_FOUND;
+    REJECT_STATUS;
   }
 }
 
-napi_value dataReceive(napi_env env, napi_callback_info info)
+napi_value dataReceive(napi_env env, napi_callback_info info, receiverState *receiver)
 {
-  return dataAndAudioReceive(env, info, "DataReceive",
+  return dataAndAudioReceive(env, info, receiver,
                              dataReceiveExecute, dataReceiveComplete);
 }
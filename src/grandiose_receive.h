@@ -16,20 +16,95 @@
 #ifndef GRANDIOSE_RECEIVE_H
 #define GRANDIOSE_RECEIVE_H
 
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
 #include "node_api.h"
 #include "grandiose_util.h"
+#include "grandiose_histogram.h"
 
 napi_value receive(napi_env env, napi_callback_info info);
-napi_value videoReceive(napi_env env, napi_callback_info info);
-napi_value audioReceive(napi_env env, napi_callback_info info);
-napi_value metadataReceive(napi_env env, napi_callback_info info);
-napi_value dataReceive(napi_env env, napi_callback_info info);
+
+// Native state of a receiver, shared by the JS receiver object and anything
+// else still using the NDI instance, e.g. outstanding zero-copy video frames.
+// The NDI receiver is destroyed when the last reference is released.
+class receiverStream;
+struct dataCarrier;
+
+// Grandiose-side counters, updated from capture threads and read by stats()
+struct receiverCounters {
+  std::atomic<uint64_t> captures{0};
+  std::atomic<uint64_t> timeouts{0};
+  std::atomic<uint64_t> captureTime{0}; // microseconds waiting in capture calls
+  std::atomic<uint64_t> completions{0};
+  std::atomic<uint64_t> completionTime{0}; // microseconds building frames on the JS thread
+  std::atomic<uint64_t> bytesCopied{0};
+  std::atomic<uint64_t> skipped{0}; // stale frames skipped by latest mode
+  std::atomic<uint64_t> streamDropped{0}; // frames dropped from a full stream ring
+};
+
+// Where the time goes for frames of one type, from NDI to JavaScript
+struct frameLatency {
+  latencyHistogram ndi; // NDI timestamp to capture, for sources with a timestamp
+  latencyHistogram queue; // capture to the start of completion on the JS thread
+  latencyHistogram complete; // building the frame and resolving its promise
+  latencyHistogram total; // capture to promise resolution
+};
+
+struct receiverState {
+  NDIlib_recv_instance_t recv = nullptr;
+  NDIlib_recv_color_format_e colorFormat = NDIlib_recv_color_format_fastest;
+  NDIlib_recv_bandwidth_e bandwidth = NDIlib_recv_bandwidth_highest;
+  bool allowVideoFields = true;
+  bool zeroCopy = false;
+  bool binaryHeader = false;
+  bool latest = false;
+  std::string sourceName;
+  std::string sourceUrl;
+  std::string name;
+  receiverStream* stream = nullptr;
+  std::atomic<int32_t> refCount{1};
+  // Spare blocks for converted audio, returned when JS buffers are collected
+  std::mutex audioLock;
+  std::vector<void*> audioBlocks;
+  // Carriers of finished captures, which hold no reference to the receiver
+  std::mutex carrierLock;
+  std::vector<dataCarrier*> spareCarriers;
+  receiverCounters counters;
+  frameLatency videoLatency;
+  frameLatency audioLatency;
+};
+
+receiverState* retainReceiver(receiverState* r);
+void releaseReceiver(receiverState* r);
+
+// Capture from a receiver, recording wait time and timeouts in its counters
+NDIlib_frame_type_e captureFrame(receiverState* r, NDIlib_video_frame_v2_t* video,
+  NDIlib_audio_frame_v3_t* audio, NDIlib_metadata_frame_t* metadata, uint32_t wait);
+
+napi_value videoReceive(napi_env env, napi_callback_info info, receiverState* receiver);
+napi_value audioReceive(napi_env env, napi_callback_info info, receiverState* receiver);
+napi_value metadataReceive(napi_env env, napi_callback_info info, receiverState* receiver);
+napi_value dataReceive(napi_env env, napi_callback_info info, receiverState* receiver);
+
+// Blocks only ever grow, so a receiver settles on a few that fit its frames.
+void* acquireAudioBlock(receiverState* r, size_t size);
+void recycleAudioBlock(receiverState* r, void* data);
+
+// A carrier bound to the receiver, reset from its spares where there is one.
+// Tidying the carrier gives it back.
+dataCarrier* acquireDataCarrier(receiverState* r);
+void recycleDataCarrier(dataCarrier* c);
 
 struct receiveCarrier : carrier {
   NDIlib_source_t* source = nullptr;
   NDIlib_recv_color_format_e colorFormat = NDIlib_recv_color_format_fastest;
   NDIlib_recv_bandwidth_e bandwidth = NDIlib_recv_bandwidth_highest;
   bool allowVideoFields = true;
+  bool zeroCopy = false;
+  bool binaryHeader = false;
+  bool latest = false;
   char* name = nullptr;
   NDIlib_recv_instance_t recv;
   ~receiveCarrier() {
@@ -40,21 +115,71 @@ struct receiveCarrier : carrier {
   }
 };
 
+// Fixed layouts of binary frame headers, read little-endian by index.js
+struct videoFrameHeader {
+  int32_t xres;
+  int32_t yres;
+  int32_t frameRateN;
+  int32_t frameRateD;
+  float pictureAspectRatio;
+  int32_t frameFormatType;
+  int32_t fourCC;
+  int32_t lineStrideBytes;
+  int64_t timestamp; // 100ns units
+  int64_t timecode; // 100ns units
+};
+
+struct audioFrameHeader {
+  int32_t sampleRate;
+  int32_t channels;
+  int32_t samples;
+  int32_t channelStrideInBytes;
+  int32_t audioFormat;
+  int32_t referenceLevel;
+  int64_t timestamp; // 100ns units
+  int64_t timecode; // 100ns units
+};
+
+// Hold a reference to the native receiver until the carrier is tidied
+void bindReceiver(dataCarrier* c, receiverState* receiver);
+void releaseFrames(dataCarrier* c);
+void convertAudio(dataCarrier* c);
+NDIlib_audio_frame_v2_t planarAudioView(const NDIlib_audio_frame_v3_t& frame);
+napi_status videoFramePropertiesToJs(napi_env env, const NDIlib_video_frame_v2_t& frame, napi_value* result);
+napi_status audioFramePropertiesToJs(napi_env env, const NDIlib_audio_frame_v3_t& frame,
+  Grandiose_audio_format_e audioFormat, int32_t referenceLevel, napi_value* result);
+napi_status videoFrameToJs(napi_env env, dataCarrier* c, napi_value* result);
+napi_status audioFrameToJs(napi_env env, dataCarrier* c, napi_value* result);
+napi_status planarChannelsToJs(napi_env env, napi_value buffer, int32_t channels,
+  int32_t samples, int32_t channelStride, napi_value* result);
+napi_status metadataFrameToJs(napi_env env, dataCarrier* c, napi_value* result);
+
+// Completions of captured frames, resolving the carrier's promise
+void videoReceiveComplete(napi_env env, napi_status asyncStatus, void* data);
+void audioReceiveComplete(napi_env env, napi_status asyncStatus, void* data);
+
 struct dataCarrier : carrier {
   uint32_t wait = 10000;
+  uint32_t skipped = 0;
+  receiverState* receiver = nullptr;
   NDIlib_recv_instance_t recv;
   NDIlib_frame_type_e frameType;
   NDIlib_video_frame_v2_t videoFrame;
-  NDIlib_audio_frame_v2_t audioFrame;
+  NDIlib_audio_frame_v3_t audioFrame;
   NDIlib_audio_frame_interleaved_16s_t audioFrame16s;
   NDIlib_audio_frame_interleaved_32f_t audioFrame32fIlvd;
+  float* audioPlanar = nullptr;
+  HR_TIME_POINT captured; // when capture returned a frame
   int32_t referenceLevel = 20;
   Grandiose_audio_format_e audioFormat = Grandiose_audio_format_float_32_separate;
   NDIlib_metadata_frame_t metadataFrame;
   ~dataCarrier() {
-    delete[] audioFrame16s.p_data;
-    delete[] audioFrame32fIlvd.p_data;
+    releaseFrames(this);
+    if (receiver != nullptr) {
+      releaseReceiver(receiver);
+    }
   }
+  void recycle() override { recycleDataCarrier(this); }
 };
 
 #endif /* GRANDIOSE_RECEIVE_H */
@@ -0,0 +1,267 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <cstddef>
+#include <Processing.NDI.Lib.h>
+
+#include "grandiose_util.h"
+#include "grandiose_receive.h"
+#include "grandiose_receiver.h"
+#include "grandiose_stream.h"
+#include "grandiose_framesync.h"
+#include "grandiose_relay.h"
+
+std::unique_ptr<Napi::FunctionReference> GrandioseReceiver::Initialize(const Napi::Env &env)
+{
+  Napi::HandleScope scope(env);
+
+  Napi::Function func = DefineClass(env, "GrandioseReceiver", {
+                                                                  InstanceMethod<&GrandioseReceiver::Video>("video", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                  InstanceMethod<&GrandioseReceiver::Audio>("audio", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                  InstanceMethod<&GrandioseReceiver::Metadata>("metadata", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                  InstanceMethod<&GrandioseReceiver::Data>("data", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+
+                                                                  InstanceMethod<&GrandioseReceiver::Stream>("stream", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                  InstanceMethod<&GrandioseReceiver::StopStream>("stopStream", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                  InstanceMethod<&GrandioseReceiver::FrameSync>("frameSync", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                  InstanceMethod<&GrandioseReceiver::Relay>("relay", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                  InstanceMethod<&GrandioseReceiver::Stats>("stats", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                  InstanceMethod<&GrandioseReceiver::Latency>("latency", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                                  InstanceMethod<&GrandioseReceiver::ResetLatency>("resetLatency", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+
+                                                                  InstanceAccessor<&GrandioseReceiver::GetSource>("source"),
+                                                                  InstanceAccessor<&GrandioseReceiver::GetColorFormat>("colorFormat"),
+                                                                  InstanceAccessor<&GrandioseReceiver::GetBandwidth>("bandwidth"),
+                                                                  InstanceAccessor<&GrandioseReceiver::GetAllowVideoFields>("allowVideoFields"),
+                                                                  InstanceAccessor<&GrandioseReceiver::GetZeroCopy>("zeroCopy"),
+                                                                  InstanceAccessor<&GrandioseReceiver::GetBinaryHeader>("binaryHeader"),
+                                                                  InstanceAccessor<&GrandioseReceiver::GetLatest>("latest"),
+                                                                  InstanceAccessor<&GrandioseReceiver::GetName>("name"),
+
+                                                              });
+
+  // Only created through grandiose.receive(), so the class is not exported
+  std::unique_ptr<Napi::FunctionReference> constructor = std::make_unique<Napi::FunctionReference>();
+  *constructor = Napi::Persistent(func);
+
+  return constructor;
+}
+
+GrandioseReceiver::GrandioseReceiver(const Napi::CallbackInfo &info) : Napi::ObjectWrap<GrandioseReceiver>(info)
+{
+  receiverState *state = (receiverState *)internalState(info);
+  if (state == nullptr)
+  {
+    Napi::TypeError::New(info.Env(), "Receivers are created with grandiose.receive()").ThrowAsJavaScriptException();
+    return;
+  }
+  receiver = retainReceiver(state);
+}
+
+GrandioseReceiver::~GrandioseReceiver()
+{
+  if (receiver != nullptr)
+    releaseReceiver(receiver);
+}
+
+Napi::Value GrandioseReceiver::Video(const Napi::CallbackInfo &info)
+{
+  return Napi::Value(info.Env(), videoReceive(info.Env(), info, receiver));
+}
+
+Napi::Value GrandioseReceiver::Audio(const Napi::CallbackInfo &info)
+{
+  return Napi::Value(info.Env(), audioReceive(info.Env(), info, receiver));
+}
+
+Napi::Value GrandioseReceiver::Metadata(const Napi::CallbackInfo &info)
+{
+  return Napi::Value(info.Env(), metadataReceive(info.Env(), info, receiver));
+}
+
+Napi::Value GrandioseReceiver::Data(const Napi::CallbackInfo &info)
+{
+  return Napi::Value(info.Env(), dataReceive(info.Env(), info, receiver));
+}
+
+Napi::Value GrandioseReceiver::Stream(const Napi::CallbackInfo &info)
+{
+  return streamReceive(info, receiver);
+}
+
+Napi::Value GrandioseReceiver::StopStream(const Napi::CallbackInfo &info)
+{
+  stopStreamReceive(receiver);
+
+  return info.Env().Undefined();
+}
+
+Napi::Value GrandioseReceiver::FrameSync(const Napi::CallbackInfo &info)
+{
+  return createFrameSync(info, receiver);
+}
+
+Napi::Value GrandioseReceiver::Relay(const Napi::CallbackInfo &info)
+{
+  return createRelay(info, receiver);
+}
+
+static Napi::Object frameCounts(const Napi::Env &env, int64_t video, int64_t audio, int64_t metadata)
+{
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("video", Napi::Number::New(env, (double)video));
+  result.Set("audio", Napi::Number::New(env, (double)audio));
+  result.Set("metadata", Napi::Number::New(env, (double)metadata));
+  return result;
+}
+
+Napi::Value GrandioseReceiver::Stats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  NDIlib_recv_performance_t total, dropped;
+  ndiLib->recv_get_performance(receiver->recv, &total, &dropped);
+  NDIlib_recv_queue_t queue;
+  ndiLib->recv_get_queue(receiver->recv, &queue);
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("total", frameCounts(env, total.video_frames, total.audio_frames, total.metadata_frames));
+  result.Set("dropped", frameCounts(env, dropped.video_frames, dropped.audio_frames, dropped.metadata_frames));
+  result.Set("queue", frameCounts(env, queue.video_frames, queue.audio_frames, queue.metadata_frames));
+
+  const receiverCounters &counters = receiver->counters;
+  Napi::Object grandiose = Napi::Object::New(env);
+  grandiose.Set("captures", Napi::Number::New(env, (double)counters.captures.load(std::memory_order_relaxed)));
+  grandiose.Set("timeouts", Napi::Number::New(env, (double)counters.timeouts.load(std::memory_order_relaxed)));
+  grandiose.Set("captureTime", Napi::Number::New(env, (double)counters.captureTime.load(std::memory_order_relaxed)));
+  grandiose.Set("completions", Napi::Number::New(env, (double)counters.completions.load(std::memory_order_relaxed)));
+  grandiose.Set("completionTime", Napi::Number::New(env, (double)counters.completionTime.load(std::memory_order_relaxed)));
+  grandiose.Set("bytesCopied", Napi::Number::New(env, (double)counters.bytesCopied.load(std::memory_order_relaxed)));
+  grandiose.Set("skipped", Napi::Number::New(env, (double)counters.skipped.load(std::memory_order_relaxed)));
+  grandiose.Set("streamDropped", Napi::Number::New(env, (double)counters.streamDropped.load(std::memory_order_relaxed)));
+  result.Set("grandiose", grandiose);
+
+  return result;
+}
+
+static Napi::Value frameLatencyToJs(const Napi::Env &env, const frameLatency &latency)
+{
+  Napi::Object result = Napi::Object::New(env);
+  const std::pair<const char *, const latencyHistogram *> histograms[] = {
+      {"ndi", &latency.ndi}, {"queue", &latency.queue}, {"complete", &latency.complete}, {"total", &latency.total}};
+  for (const auto &histogram : histograms)
+  {
+    napi_value value;
+    if (histogramToJs(env, *histogram.second, &value) != napi_ok)
+      return env.Undefined();
+    result.Set(histogram.first, Napi::Value(env, value));
+  }
+  return result;
+}
+
+Napi::Value GrandioseReceiver::Latency(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("video", frameLatencyToJs(env, receiver->videoLatency));
+  result.Set("audio", frameLatencyToJs(env, receiver->audioLatency));
+  return result;
+}
+
+Napi::Value GrandioseReceiver::ResetLatency(const Napi::CallbackInfo &info)
+{
+  for (frameLatency *latency : {&receiver->videoLatency, &receiver->audioLatency})
+  {
+    latency->ndi.reset();
+    latency->queue.reset();
+    latency->complete.reset();
+    latency->total.reset();
+  }
+
+  return info.Env().Undefined();
+}
+
+Napi::Value GrandioseReceiver::GetSource(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  // Built once so that repeated reads return the same object
+  if (source.IsEmpty())
+  {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("name", receiver->sourceName);
+    if (!receiver->sourceUrl.empty())
+      result.Set("urlAddress", receiver->sourceUrl);
+    source = Napi::Persistent(result);
+  }
+
+  return source.Value();
+}
+
+Napi::Value GrandioseReceiver::GetColorFormat(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), (int32_t)receiver->colorFormat);
+}
+
+Napi::Value GrandioseReceiver::GetBandwidth(const Napi::CallbackInfo &info)
+{
+  return Napi::Number::New(info.Env(), (int32_t)receiver->bandwidth);
+}
+
+Napi::Value GrandioseReceiver::GetAllowVideoFields(const Napi::CallbackInfo &info)
+{
+  return Napi::Boolean::New(info.Env(), receiver->allowVideoFields);
+}
+
+Napi::Value GrandioseReceiver::GetZeroCopy(const Napi::CallbackInfo &info)
+{
+  return Napi::Boolean::New(info.Env(), receiver->zeroCopy);
+}
+
+Napi::Value GrandioseReceiver::GetBinaryHeader(const Napi::CallbackInfo &info)
+{
+  return Napi::Boolean::New(info.Env(), receiver->binaryHeader);
+}
+
+Napi::Value GrandioseReceiver::GetLatest(const Napi::CallbackInfo &info)
+{
+  return Napi::Boolean::New(info.Env(), receiver->latest);
+}
+
+Napi::Value GrandioseReceiver::GetName(const Napi::CallbackInfo &info)
+{
+  if (receiver->name.empty())
+    return info.Env().Undefined();
+
+  return Napi::String::New(info.Env(), receiver->name);
+}
+
+napi_status newReceiver(napi_env env, receiverState *state, napi_value *result)
+{
+  Napi::Env napiEnv(env);
+  GrandioseInstanceData *instance = napiEnv.GetInstanceData<GrandioseInstanceData>();
+
+  Napi::Object receiver;
+  if (!newInternal(*instance->receiver, state).UnwrapTo(&receiver))
+  {
+    napi_value exception;
+    napi_get_and_clear_last_exception(env, &exception);
+    return napi_pending_exception;
+  }
+
+  *result = receiver;
+  return napi_ok;
+}
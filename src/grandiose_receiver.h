@@ -0,0 +1,61 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#pragma once
+
+#include "napi.h"
+#include "grandiose_util.h"
+#include "grandiose_receive.h"
+#include <cstddef>
+#include <Processing.NDI.Lib.h>
+
+// Receiver objects resolved by grandiose.receive(). Capture methods live on the
+// prototype and go straight to the native receiver state held here.
+class GrandioseReceiver : public Napi::ObjectWrap<GrandioseReceiver>
+{
+public:
+  GrandioseReceiver(const Napi::CallbackInfo &info);
+  static std::unique_ptr<Napi::FunctionReference> Initialize(const Napi::Env &env);
+
+  ~GrandioseReceiver();
+
+private:
+  Napi::Value Video(const Napi::CallbackInfo &info);
+  Napi::Value Audio(const Napi::CallbackInfo &info);
+  Napi::Value Metadata(const Napi::CallbackInfo &info);
+  Napi::Value Data(const Napi::CallbackInfo &info);
+  Napi::Value Stream(const Napi::CallbackInfo &info);
+  Napi::Value StopStream(const Napi::CallbackInfo &info);
+  Napi::Value FrameSync(const Napi::CallbackInfo &info);
+  Napi::Value Relay(const Napi::CallbackInfo &info);
+  Napi::Value Stats(const Napi::CallbackInfo &info);
+  Napi::Value Latency(const Napi::CallbackInfo &info);
+  Napi::Value ResetLatency(const Napi::CallbackInfo &info);
+
+  Napi::Value GetSource(const Napi::CallbackInfo &info);
+  Napi::Value GetColorFormat(const Napi::CallbackInfo &info);
+  Napi::Value GetBandwidth(const Napi::CallbackInfo &info);
+  Napi::Value GetAllowVideoFields(const Napi::CallbackInfo &info);
+  Napi::Value GetZeroCopy(const Napi::CallbackInfo &info);
+  Napi::Value GetBinaryHeader(const Napi::CallbackInfo &info);
+  Napi::Value GetLatest(const Napi::CallbackInfo &info);
+  Napi::Value GetName(const Napi::CallbackInfo &info);
+
+  receiverState *receiver = nullptr;
+  Napi::ObjectReference source;
+};
+
+// Wrap native receiver state in a new receiver object, which takes its own reference
+napi_status newReceiver(napi_env env, receiverState *state, napi_value *result);
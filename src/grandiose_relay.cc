@@ -0,0 +1,263 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <Processing.NDI.Lib.h>
+
+#include "grandiose_util.h"
+#include "grandiose_receive.h"
+#include "grandiose_send.h"
+#include "grandiose_relay.h"
+#include "grandiose_trace.h"
+#include "grandiose_metrics.h"
+#include "util.h"
+
+// How long a capture waits before checking whether the relay has been stopped
+#define RELAY_WAIT 100
+
+std::unique_ptr<Napi::FunctionReference> GrandioseRelay::Initialize(const Napi::Env &env)
+{
+  Napi::HandleScope scope(env);
+
+  Napi::Function func = DefineClass(env, "GrandioseRelay", {
+                                                               InstanceMethod<&GrandioseRelay::Start>("start", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                               InstanceMethod<&GrandioseRelay::Stop>("stop", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+                                                               InstanceMethod<&GrandioseRelay::Stats>("stats", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+
+                                                               InstanceAccessor<&GrandioseRelay::GetRunning>("running"),
+
+                                                           });
+
+  // Only created through receiver.relay(), so the class is not exported
+  std::unique_ptr<Napi::FunctionReference> constructor = std::make_unique<Napi::FunctionReference>();
+  *constructor = Napi::Persistent(func);
+
+  return constructor;
+}
+
+GrandioseRelay::GrandioseRelay(const Napi::CallbackInfo &info) : Napi::ObjectWrap<GrandioseRelay>(info)
+{
+  Napi::Env env = info.Env();
+
+  receiverState *state = (receiverState *)internalState(info);
+  if (state == nullptr || info.Length() < 2 || !info[1].IsObject())
+  {
+    Napi::TypeError::New(env, "Relays are created with receiver.relay()").ThrowAsJavaScriptException();
+    return;
+  }
+
+  if (info.Length() > 2 && !info[2].IsUndefined() && !info[2].IsNull())
+  {
+    if (!info[2].IsObject())
+    {
+      Napi::TypeError::New(env, "Expected an options object").ThrowAsJavaScriptException();
+      return;
+    }
+    Napi::Object rawOptions = info[2].As<Napi::Object>();
+    if (!parseOptionalBoolean(env, rawOptions.Get("video"), video) ||
+        !parseOptionalBoolean(env, rawOptions.Get("audio"), audio) ||
+        !parseOptionalBoolean(env, rawOptions.Get("metadata"), metadata))
+    {
+      Napi::TypeError::New(env, "options.video, options.audio and options.metadata must be booleans").ThrowAsJavaScriptException();
+      return;
+    }
+  }
+
+  senderState *target;
+  if (getSender(env, info[1], &target) != napi_ok || target->send == nullptr)
+  {
+    Napi::TypeError::New(env, "Expected a sender that has not been destroyed").ThrowAsJavaScriptException();
+    return;
+  }
+  if (target->relays > 0)
+  {
+    Napi::Error::New(env, "Another relay is already sending through this sender").ThrowAsJavaScriptException();
+    return;
+  }
+
+  // Counted so that the sender outlives the thread, even if its external is
+  // collected first
+  sender = retainSender(target);
+  receiver = retainReceiver(state);
+  start();
+}
+
+GrandioseRelay::~GrandioseRelay()
+{
+  stop();
+  if (receiver != nullptr)
+    releaseReceiver(receiver);
+  if (sender != nullptr)
+    releaseSender(Env(), sender);
+}
+
+void GrandioseRelay::start()
+{
+  if (running)
+    return;
+
+  sender->relays++;
+  running = true;
+  thread = std::thread(&GrandioseRelay::run, this);
+}
+
+void GrandioseRelay::stop()
+{
+  if (!running)
+    return;
+
+  running = false;
+  if (thread.joinable())
+    thread.join();
+  sender->relays--;
+}
+
+void GrandioseRelay::run()
+{
+  NDIlib_video_frame_v2_t frames[2];
+  NDIlib_audio_frame_v3_t audioFrame;
+  NDIlib_metadata_frame_t metadataFrame;
+  // Index of the video frame that NDI may still be reading from
+  int sending = -1;
+  traceThreadName("grandiose relay");
+
+  while (running)
+  {
+    int next = (sending == 0) ? 1 : 0;
+    NDIlib_frame_type_e frameType;
+    {
+      traceScope span(TRACE_RECEIVE, "relayCapture");
+      frameType = captureFrame(receiver,
+                               video ? &frames[next] : nullptr,
+                               audio ? &audioFrame : nullptr,
+                               metadata ? &metadataFrame : nullptr,
+                               RELAY_WAIT);
+    }
+    HR_TIME_POINT start = NOW;
+    switch (frameType)
+    {
+    case NDIlib_frame_type_video:
+    {
+      // Asynchronous sends return straight away, with NDI done with the
+      // previous frame, which can then be given back to the receiver
+      traceScope span(TRACE_SEND, "relaySendVideo");
+      ndiLib->send_send_video_async_v2(sender->send, &frames[next]);
+      countFrame(metrics.framesSent, metrics.bytesSent, METRIC_VIDEO, videoFrameBytes(frames[next]));
+      if (sending >= 0)
+        ndiLib->recv_free_video_v2(receiver->recv, &frames[sending]);
+      sending = next;
+      counters.video.fetch_add(1, std::memory_order_relaxed);
+      break;
+    }
+    case NDIlib_frame_type_audio:
+    {
+      traceScope span(TRACE_SEND, "relaySendAudio");
+      ndiLib->send_send_audio_v3(sender->send, &audioFrame);
+      countFrame(metrics.framesSent, metrics.bytesSent, METRIC_AUDIO, audioFrameBytes(audioFrame));
+      ndiLib->recv_free_audio_v3(receiver->recv, &audioFrame);
+      counters.audio.fetch_add(1, std::memory_order_relaxed);
+      break;
+    }
+    case NDIlib_frame_type_metadata:
+    {
+      traceScope span(TRACE_SEND, "relaySendMetadata");
+      ndiLib->send_send_metadata(sender->send, &metadataFrame);
+      countFrame(metrics.framesSent, metrics.bytesSent, METRIC_METADATA, metadataFrameBytes(metadataFrame));
+      ndiLib->recv_free_metadata(receiver->recv, &metadataFrame);
+      counters.metadata.fetch_add(1, std::memory_order_relaxed);
+      break;
+    }
+    case NDIlib_frame_type_error:
+      counters.connectionLost.fetch_add(1, std::memory_order_relaxed);
+      std::this_thread::sleep_for(std::chrono::milliseconds(RELAY_WAIT));
+      continue;
+    default:
+      continue;
+    }
+    counters.sendTime.fetch_add(microTime(start), std::memory_order_relaxed);
+  }
+
+  // Flush so that the last frame sent can be freed
+  if (sending >= 0)
+  {
+    traceScope span(TRACE_SEND, "relayFlush");
+    ndiLib->send_send_video_async_v2(sender->send, nullptr);
+    ndiLib->recv_free_video_v2(receiver->recv, &frames[sending]);
+  }
+}
+
+Napi::Value GrandioseRelay::Start(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  if (sender == nullptr || sender->send == nullptr)
+  {
+    Napi::Error::New(env, "The relay's sender has been destroyed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!running && sender->relays > 0)
+  {
+    Napi::Error::New(env, "Another relay is already sending through this sender").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  start();
+
+  return env.Undefined();
+}
+
+Napi::Value GrandioseRelay::Stop(const Napi::CallbackInfo &info)
+{
+  stop();
+
+  return info.Env().Undefined();
+}
+
+Napi::Value GrandioseRelay::Stats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("running", Napi::Boolean::New(env, running));
+  result.Set("video", Napi::Number::New(env, (double)counters.video.load(std::memory_order_relaxed)));
+  result.Set("audio", Napi::Number::New(env, (double)counters.audio.load(std::memory_order_relaxed)));
+  result.Set("metadata", Napi::Number::New(env, (double)counters.metadata.load(std::memory_order_relaxed)));
+  result.Set("connectionLost", Napi::Number::New(env, (double)counters.connectionLost.load(std::memory_order_relaxed)));
+  result.Set("sendTime", Napi::Number::New(env, (double)counters.sendTime.load(std::memory_order_relaxed)));
+  return result;
+}
+
+Napi::Value GrandioseRelay::GetRunning(const Napi::CallbackInfo &info)
+{
+  return Napi::Boolean::New(info.Env(), running);
+}
+
+Napi::Value createRelay(const Napi::CallbackInfo &info, receiverState *receiver)
+{
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject())
+  {
+    Napi::TypeError::New(env, "Expected a sender to relay to").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  GrandioseInstanceData *instance = env.GetInstanceData<GrandioseInstanceData>();
+  Napi::Object relay;
+  if (!newInternal(*instance->relay, receiver, {info[0], info.Length() > 1 ? info[1] : env.Undefined()})
+           .UnwrapTo(&relay))
+    return env.Undefined();
+  return relay;
+}
@@ -0,0 +1,69 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include "napi.h"
+#include "grandiose_util.h"
+#include "grandiose_receive.h"
+#include "grandiose_send.h"
+#include <cstddef>
+#include <Processing.NDI.Lib.h>
+
+struct relayCounters
+{
+  std::atomic<uint64_t> video{0};
+  std::atomic<uint64_t> audio{0};
+  std::atomic<uint64_t> metadata{0};
+  std::atomic<uint64_t> connectionLost{0};
+  std::atomic<uint64_t> sendTime{0}; // microseconds
+};
+
+// Forwards frames from a receiver to a sender on a dedicated thread, so that
+// relayed frames are never copied into JavaScript. While running, the relay is
+// the only thing that may capture from the receiver or send video on the sender.
+class GrandioseRelay : public Napi::ObjectWrap<GrandioseRelay>
+{
+public:
+  GrandioseRelay(const Napi::CallbackInfo &info);
+  static std::unique_ptr<Napi::FunctionReference> Initialize(const Napi::Env &env);
+
+  ~GrandioseRelay();
+
+private:
+  Napi::Value Start(const Napi::CallbackInfo &info);
+  Napi::Value Stop(const Napi::CallbackInfo &info);
+  Napi::Value Stats(const Napi::CallbackInfo &info);
+  Napi::Value GetRunning(const Napi::CallbackInfo &info);
+
+  void start();
+  void stop();
+  void run();
+
+  receiverState *receiver = nullptr;
+  senderState *sender = nullptr;
+  bool video = true;
+  bool audio = true;
+  bool metadata = true;
+
+  std::thread thread;
+  std::atomic<bool> running{false};
+  relayCounters counters;
+};
+
+// receiver.relay(sender, options)
+Napi::Value createRelay(const Napi::CallbackInfo &info, receiverState *receiver);
@@ -16,44 +16,171 @@
 
 /*  standard includes  */
 #include <string>
+#include <vector>
 
 /*  NDI API  */
 #include <Processing.NDI.Lib.h>
-#ifdef _WIN32
-#ifdef _WIN64
-#pragma comment(lib, "Processing.NDI.Lib.x64.lib")
-#else // _WIN64
-#pragma comment(lib, "Processing.NDI.Lib.x86.lib")
-#endif // _WIN64
-#endif // _WIN32
-
 /*  own library API  */
 #include "grandiose_util.h"
 #include "grandiose_find.h"
 #include "grandiose_routing.h"
+#include "grandiose_metrics.h"
+#include "util.h"
+
+/*  reference counting, as salvos may still be switching a router whose
+    object has been destroyed  */
+routingState* retainRouting(routingState* r) {
+    r->refCount.fetch_add(1);
+    return r;
+}
+
+void releaseRouting(routingState* r) {
+    if (r->refCount.fetch_sub(1) == 1) {
+        if (r->routing != nullptr) {
+            ndiLib->routing_destroy(r->routing);
+            metrics.routers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        delete r;
+    }
+}
+
+std::unique_ptr<Napi::FunctionReference> GrandioseRouting::Initialize(const Napi::Env &env) {
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "GrandioseRouting", {
+        InstanceMethod<&GrandioseRouting::Destroy>("destroy", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+        InstanceMethod<&GrandioseRouting::Change>("change", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+        InstanceMethod<&GrandioseRouting::Clear>("clear", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+        InstanceMethod<&GrandioseRouting::Connections>("connections", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+        InstanceMethod<&GrandioseRouting::SourceName>("sourcename", static_cast<napi_property_attributes>(napi_writable | napi_configurable)),
+
+        InstanceAccessor<&GrandioseRouting::GetName>("name"),
+        InstanceAccessor<&GrandioseRouting::GetGroups>("groups"),
+    });
+
+    /*  only created through grandiose.routing(), so the class is not exported  */
+    std::unique_ptr<Napi::FunctionReference> constructor = std::make_unique<Napi::FunctionReference>();
+    *constructor = Napi::Persistent(func);
+
+    return constructor;
+}
+
+GrandioseRouting::GrandioseRouting(const Napi::CallbackInfo &info) : Napi::ObjectWrap<GrandioseRouting>(info) {
+    /*  takes over the reference made for it  */
+    state = (routingState *) internalState(info);
+    if (state == nullptr) {
+        Napi::TypeError::New(info.Env(), "Routing is created with grandiose.routing()").ThrowAsJavaScriptException();
+        return;
+    }
+}
 
-/*  own module API  */
-napi_value routing_destroy    (napi_env, napi_callback_info);
-napi_value routing_change     (napi_env, napi_callback_info);
-napi_value routing_clear      (napi_env, napi_callback_info);
-napi_value routing_connections(napi_env, napi_callback_info);
-napi_value routing_sourcename (napi_env, napi_callback_info);
-
-/*  wrapper structure for embedded value  */
-typedef struct embeddedValue {
-    void *value;
-} embeddedValue_t;
-
-/*  callback for destroying embedded value  */
-void finalizeRouting(napi_env env, void* data, void* hint) {
-    embeddedValue_t *embeddedValue = (embeddedValue_t *)data;
-    if (embeddedValue != nullptr) {
-        NDIlib_routing_instance_t routing = (NDIlib_routing_instance_t)(embeddedValue->value);
-        if (routing != nullptr)
-            NDIlib_routing_destroy(routing);
-        embeddedValue->value = nullptr;
+GrandioseRouting::~GrandioseRouting() {
+    if (state != nullptr)
+        releaseRouting(state);
+}
+
+bool GrandioseRouting::checkDestroyed(const Napi::Env &env) {
+    if (state == nullptr) {
+        Napi::Error::New(env, "NDI routing already destroyed").ThrowAsJavaScriptException();
+        return true;
     }
-    free(data);
+    return false;
+}
+
+/*  API method "routing.destroy()"  */
+Napi::Value GrandioseRouting::Destroy(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+
+    /*  the NDI router goes once no salvo is switching it either  */
+    if (state != nullptr) {
+        releaseRouting(state);
+        state = nullptr;
+    }
+
+    deferred.Resolve(env.Undefined());
+    return deferred.Promise();
+}
+
+/*  source objects as used by routing.change() and salvos  */
+static bool parseRoutingSource(const Napi::Env &env, const Napi::Value &source, std::string &name, std::string &urlAddress) {
+    if (!source.IsObject() || source.IsArray()) {
+        Napi::TypeError::New(env, "Source property must be an object and not an array.").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object object = source.As<Napi::Object>();
+    Napi::Value rawName = object.Get("name").UnwrapOr(env.Undefined());
+    if (!rawName.IsString()) {
+        Napi::TypeError::New(env, "Source property must have a 'name' sub-property that is of type string.").ThrowAsJavaScriptException();
+        return false;
+    }
+    name = rawName.As<Napi::String>().Utf8Value();
+    if (!parseString(env, object.Get("urlAddress"), urlAddress)) {
+        Napi::TypeError::New(env, "Source 'urlAddress' sub-property must be of type string.").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+/*  API method "routing.change()"  */
+Napi::Value GrandioseRouting::Change(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (checkDestroyed(env))
+        return env.Undefined();
+
+    if (info.Length() < 1) {
+        Napi::Error::New(env, "Missing source argument").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    std::string name, urlAddress;
+    if (!parseRoutingSource(env, info[0], name, urlAddress))
+        return env.Undefined();
+
+    /*  call NDI API functionality  */
+    NDIlib_source_t source(name.c_str(), urlAddress.empty() ? nullptr : urlAddress.c_str());
+    bool ok = ndiLib->routing_change(state->routing, &source);
+
+    return Napi::Boolean::New(env, ok);
+}
+
+/*  API method "routing.clear()"  */
+Napi::Value GrandioseRouting::Clear(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (checkDestroyed(env))
+        return env.Undefined();
+
+    return Napi::Boolean::New(env, ndiLib->routing_clear(state->routing));
+}
+
+/*  API method "routing.connections()"  */
+Napi::Value GrandioseRouting::Connections(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (checkDestroyed(env))
+        return env.Undefined();
+
+    return Napi::Number::New(env, ndiLib->routing_get_no_connections(state->routing, 0));
+}
+
+/*  API method "routing.sourcename()"  */
+Napi::Value GrandioseRouting::SourceName(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (checkDestroyed(env))
+        return env.Undefined();
+
+    const NDIlib_source_t *source = ndiLib->routing_get_source_name(state->routing);
+    return Napi::String::New(env, source->p_ndi_name);
+}
+
+Napi::Value GrandioseRouting::GetName(const Napi::CallbackInfo &info) {
+    if (state == nullptr || state->name.empty())
+        return info.Env().Undefined();
+    return Napi::String::New(info.Env(), state->name);
+}
+
+Napi::Value GrandioseRouting::GetGroups(const Napi::CallbackInfo &info) {
+    if (state == nullptr || state->groups.empty())
+        return info.Env().Undefined();
+    return Napi::String::New(info.Env(), state->groups);
 }
 
 /*  callback for executing method routing()  */
@@ -62,93 +189,51 @@ void routingExecute(napi_env env, void* data) {
     NDIlib_routing_create_t routingConfig;
     routingConfig.p_ndi_name = c->name;
     routingConfig.p_groups   = c->groups;
-    c->routing = NDIlib_routing_create(&routingConfig);
+    c->routing = ndiLib->routing_create(&routingConfig);
     if (!c->routing) {
         c->status   = GRANDIOSE_ROUTING_CREATE_FAIL;
         c->errorMsg = "Failed to create NDI routing.";
         return;
     }
+    metrics.routers.fetch_add(1, std::memory_order_relaxed);
 }
 
 /*  callback for completing method routing()  */
 void routingComplete(napi_env env, napi_status asyncStatus, void* data) {
     routingCarrier *c = (routingCarrier *)data;
-   
+
     /*  check status  */
     if (asyncStatus != napi_ok) {
         c->status   = asyncStatus;
         c->errorMsg = "Async routing creation failed to complete.";
     }
     REJECT_STATUS;
-   
-    /*  create result object  */
-    napi_value result;
-    c->status = napi_create_object(env, &result);
-    REJECT_STATUS;
-   
-    /*  embed the native routing object  */
-    napi_value embedded;
-    embeddedValue_t *embeddedValue = (embeddedValue_t *)malloc(sizeof(embeddedValue_t));
-    embeddedValue->value = c->routing;
-    c->status = napi_create_external(env, embeddedValue, finalizeRouting, nullptr, &embedded);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "embedded", embedded);
-    REJECT_STATUS;
 
-    /*  create "name" property  */
-    napi_value name;
-    if (c->name != nullptr) {
-      c->status = napi_create_string_utf8(env, c->name, NAPI_AUTO_LENGTH, &name);
-      REJECT_STATUS;
-      c->status = napi_set_named_property(env, result, "name", name);
-      REJECT_STATUS;
-    }
-   
-    /*  create "groups" property  */
-    napi_value groups;
-    if (c->groups != nullptr) {
-      c->status = napi_create_string_utf8(env, c->groups, NAPI_AUTO_LENGTH, &groups);
-      REJECT_STATUS;
-      c->status = napi_set_named_property(env, result, "groups", groups);
-      REJECT_STATUS;
+    /*  wrap the native routing object, which the new object takes over  */
+    routingState *state = new routingState;
+    state->routing = c->routing;
+    if (c->name != nullptr)
+        state->name = c->name;
+    if (c->groups != nullptr)
+        state->groups = c->groups;
+
+    Napi::Env napiEnv(env);
+    GrandioseInstanceData *instance = napiEnv.GetInstanceData<GrandioseInstanceData>();
+    Napi::Object result;
+    if (!newInternal(*instance->routing, state).UnwrapTo(&result)) {
+        releaseRouting(state);
+        napi_value error;
+        napi_get_and_clear_last_exception(env, &error);
+        napi_reject_deferred(env, c->_deferred, error);
+        tidyCarrier(env, c);
+        return;
     }
-   
-    /*  attach the "destroy()" method  */
-    napi_value fn;
-    c->status = napi_create_function(env, "destroy", NAPI_AUTO_LENGTH, routing_destroy, nullptr, &fn);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "destroy", fn);
-    REJECT_STATUS;
 
-    /*  attach the "change()" method  */
-    c->status = napi_create_function(env, "change", NAPI_AUTO_LENGTH, routing_change, nullptr, &fn);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "change", fn);
-    REJECT_STATUS;
-    
-    /*  attach the "clear()" method  */
-    c->status = napi_create_function(env, "clear", NAPI_AUTO_LENGTH, routing_clear, nullptr, &fn);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "clear", fn);
-    REJECT_STATUS;
-   
-    /*  attach the "connections()" method  */
-    c->status = napi_create_function(env, "connections", NAPI_AUTO_LENGTH, routing_connections, nullptr, &fn);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "connections", fn);
-    REJECT_STATUS;
-   
-    /*  attach the "sourcename()" method  */
-    c->status = napi_create_function(env, "sourcename", NAPI_AUTO_LENGTH, routing_sourcename, nullptr, &fn);
-    REJECT_STATUS;
-    c->status = napi_set_named_property(env, result, "sourcename", fn);
-    REJECT_STATUS;
-   
     /*  resolve the promise  */
     napi_status status;
     status = napi_resolve_deferred(env, c->_deferred, result);
     FLOATING_STATUS;
-   
+
     /*  cleanup  */
     tidyCarrier(env, c);
 }
@@ -162,6 +247,11 @@ napi_value routing(napi_env env, napi_callback_info info) {
     napi_value promise;
     c->status = napi_create_promise(env, &c->_deferred, &promise);
     REJECT_RETURN;
+
+    /*  open the NDI library on first use  */
+    std::string error;
+    if (!loadNdi(error))
+        REJECT_ERROR_RETURN(error, GRANDIOSE_NDI_LOAD_FAIL);
    
     /*  fetch argument  */
     size_t argc = 1;
@@ -211,224 +301,119 @@ napi_value routing(napi_env env, napi_callback_info info) {
         REJECT_RETURN;
     }
    
-    /*  create an internal async resource  */
-    napi_value resource_name;
-    c->status = napi_create_string_utf8(env, "Routing", NAPI_AUTO_LENGTH, &resource_name);
-    REJECT_RETURN;
-    c->status = napi_create_async_work(env, NULL, resource_name, routingExecute, routingComplete, c, &c->_request);
-    REJECT_RETURN;
-    c->status = napi_queue_async_work(env, c->_request);
+    /*  queue the work on the executor  */
+    c->status = queueWork(env, c, routingExecute, routingComplete, c);
     REJECT_RETURN;
 
     return promise;
 }
 
-/*  API method "routing.destroy()"  */
-napi_value routing_destroy(napi_env env, napi_callback_info info) {
-    /*  create a new Promise carrier object  */
-    carrier *c = new carrier;
-    napi_value promise;
-    c->status = napi_create_promise(env, &c->_deferred, &promise);
-    REJECT_RETURN;
-
-    /*  fetch the NDI routing wrapper object ("this" of the "destroy" method)  */
-    size_t argc = 1;
-    napi_value args[1];
-    napi_value thisValue;
-    c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-    REJECT_RETURN;
-
-    /*  fetch NDI routing external object  */
-    napi_value embeddedValue;
-    c->status = napi_get_named_property(env, thisValue, "embedded", &embeddedValue);
-    REJECT_RETURN;
-
-    /*  ensure it was still not manually destroyed  */
-    napi_valuetype result;
-    if (napi_typeof(env, embeddedValue, &result) != napi_ok)
-        NAPI_THROW_ERROR("NDI routing already destroyed");
-    if (result == napi_external) {
-        /*  fetch NDI routing native object  */
-        embeddedValue_t *embeddedData;
-        c->status = napi_get_value_external(env, embeddedValue, (void **)&embeddedData);
-        REJECT_RETURN;
-        NDIlib_routing_instance_t routing = (NDIlib_routing_instance_t)(embeddedData->value);
+/*  callback for executing method routing.salvo(), switching every router
+    in one go  */
+void salvoExecute(napi_env env, void* data) {
+    salvoCarrier *c = (salvoCarrier *)data;
+    for (salvoChange &change : c->changes) {
+        if (change.clear) {
+            change.ok = ndiLib->routing_clear(change.router->routing);
+        } else {
+            NDIlib_source_t source(change.name.c_str(),
+                change.urlAddress.empty() ? nullptr : change.urlAddress.c_str());
+            change.ok = ndiLib->routing_change(change.router->routing, &source);
+        }
+    }
+}
 
-        /*  call the NDI API  */
-        NDIlib_routing_destroy(routing);
+/*  callback for completing method routing.salvo()  */
+void salvoComplete(napi_env env, napi_status asyncStatus, void* data) {
+    salvoCarrier *c = (salvoCarrier *)data;
 
-        /*  indicate to finalizeRouting that the NDI routing native object is already destroyed  */
-        embeddedData->value = nullptr;
-        REJECT_RETURN;
+    /*  check status  */
+    if (asyncStatus != napi_ok) {
+        c->status   = asyncStatus;
+        c->errorMsg = "Async routing salvo failed to complete.";
     }
+    REJECT_STATUS;
 
-    /*  resolve promise  */
-    napi_value undefined;
-    napi_get_undefined(env, &undefined);
-    napi_resolve_deferred(env, c->_deferred, undefined);
-
-    return promise;
-}
+    /*  resolve with whether each change succeeded  */
+    napi_value result, ok;
+    c->status = napi_create_array_with_length(env, c->changes.size(), &result);
+    REJECT_STATUS;
+    for (size_t i = 0; i < c->changes.size(); i++) {
+        c->status = napi_get_boolean(env, c->changes[i].ok, &ok);
+        REJECT_STATUS;
+        c->status = napi_set_element(env, result, (uint32_t)i, ok);
+        REJECT_STATUS;
+    }
 
-/*  API method "routing.change()"  */
-napi_value routing_change(napi_env env, napi_callback_info info) {
     napi_status status;
+    status = napi_resolve_deferred(env, c->_deferred, result);
+    FLOATING_STATUS;
 
-    /*  fetch arguments  */
-    size_t argc = 1;
-    napi_value args[1];
-    napi_value thisValue;
-    status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-    CHECK_STATUS;
-
-    /*  fetch embedded NDI native routing object  */
-    napi_value embeddedValue;
-    status = napi_get_named_property(env, thisValue, "embedded", &embeddedValue);
-    CHECK_STATUS;
-    embeddedValue_t *embeddedData;
-    status = napi_get_value_external(env, embeddedValue, (void **)&embeddedData);
-    CHECK_STATUS;
-    NDIlib_routing_instance_t routing = (NDIlib_routing_instance_t)(embeddedData->value);
-
-    /*  fetch source argument  */
-    if (argc != (size_t)1)
-        NAPI_THROW_ERROR("Missing source argument");
-    napi_value source = args[0];
-    napi_valuetype type;
-    status = napi_typeof(env, source, &type);
-    CHECK_STATUS;
-    bool isArray;
-    status = napi_is_array(env, source, &isArray);
-    CHECK_STATUS;
-    if ((type != napi_object) || isArray)
-        NAPI_THROW_ERROR("Source property must be an object and not an array.")
-
-    /*  check source's name argument  */
-    napi_value checkType;
-    status = napi_get_named_property(env, source, "name", &checkType);
-    CHECK_STATUS;
-    status = napi_typeof(env, checkType, &type);
-    CHECK_STATUS;
-    if (type != napi_string)
-        NAPI_THROW_ERROR("Source property must have a 'name' sub-property that is of type string.")
-
-    /*  check source's urlAddress argument  */
-    status = napi_get_named_property(env, source, "urlAddress", &checkType);
-    CHECK_STATUS;
-    status = napi_typeof(env, checkType, &type);
-    CHECK_STATUS;
-    if (type != napi_undefined && type != napi_string)
-        NAPI_THROW_ERROR("Source 'urlAddress' sub-property must be of type string.")
-  
-    /*  create NDI native source object  */
-    NDIlib_source_t *ndi_source = new NDIlib_source_t();
-    status = makeNativeSource(env, source, ndi_source);
-    CHECK_STATUS;
-  
-    /*  call NDI API functionality  */
-    int ok = NDIlib_routing_change(routing, ndi_source);
-  
-    /*  cleanup resource  */
-    delete ndi_source;
-  
-    /*  return a boolean result  */
-    napi_value result;
-    status = napi_get_boolean(env, ok, &result);
-    CHECK_STATUS;
-  
-    return result;
-}
-
-/*  API method "routing.clear()"  */
-napi_value routing_clear(napi_env env, napi_callback_info info) {
-    napi_status status;
-    
-    /*  fetch arguments  */
-    size_t argc = 1;
-    napi_value args[1];
-    napi_value thisValue;
-    status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-    CHECK_STATUS;
-    
-    /*  fetch embedded NDI native routing object  */
-    napi_value embeddedValue;
-    status = napi_get_named_property(env, thisValue, "embedded", &embeddedValue);
-    CHECK_STATUS;
-    embeddedValue_t *embeddedData;
-    status = napi_get_value_external(env, embeddedValue, (void **)&embeddedData);
-    CHECK_STATUS;
-    NDIlib_routing_instance_t routing = (NDIlib_routing_instance_t)(embeddedData->value);
-    
-    /*  call NDI API functionality  */
-    int ok = NDIlib_routing_clear(routing);
-
-    /*  return a boolean result  */
-    napi_value result;
-    status = napi_get_boolean(env, ok, &result);
-    CHECK_STATUS;
-    
-    return result;
+    tidyCarrier(env, c);
 }
 
-/*  API method "routing.connections()"  */
-napi_value routing_connections(napi_env env, napi_callback_info info) {
-    napi_status status;
-   
-    /*  fetch arguments  */
-    size_t argc = 1;
-    napi_value args[1];
-    napi_value thisValue;
-    status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-    CHECK_STATUS;
-   
-    /*  fetch embedded NDI native routing object  */
-    napi_value embeddedValue;
-    status = napi_get_named_property(env, thisValue, "embedded", &embeddedValue);
-    CHECK_STATUS;
-    embeddedValue_t *embeddedData;
-    status = napi_get_value_external(env, embeddedValue, (void **)&embeddedData);
-    CHECK_STATUS;
-    NDIlib_routing_instance_t routing = (NDIlib_routing_instance_t)(embeddedData->value);
-   
-    /*  call NDI API functionality  */
-    int conns = NDIlib_routing_get_no_connections(routing, 0);
+/*  the API method "routing.salvo()", taking an array of { router, source }
+    where a missing source clears the router  */
+napi_value routingSalvo(napi_env env, napi_callback_info info) {
+    salvoCarrier *c = new salvoCarrier;
 
-    /*  return a numeric result  */
-    napi_value result;
-    status = napi_create_int32(env, (int32_t)conns, &result);
-    CHECK_STATUS;
-   
-    return result;
-}
+    /*  create result promise  */
+    napi_value promise;
+    c->status = napi_create_promise(env, &c->_deferred, &promise);
+    REJECT_RETURN;
 
-/*  API method "routing.sourcename()"  */
-napi_value routing_sourcename(napi_env env, napi_callback_info info) {
-    napi_status status;
-   
-    /*  fetch arguments  */
+    /*  fetch argument  */
     size_t argc = 1;
     napi_value args[1];
-    napi_value thisValue;
-    status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-    CHECK_STATUS;
-   
-    /*  fetch embedded NDI native routing object  */
-    napi_value embeddedValue;
-    status = napi_get_named_property(env, thisValue, "embedded", &embeddedValue);
-    CHECK_STATUS;
-    embeddedValue_t *embeddedData;
-    status = napi_get_value_external(env, embeddedValue, (void **)&embeddedData);
-    CHECK_STATUS;
-    NDIlib_routing_instance_t routing = (NDIlib_routing_instance_t)(embeddedData->value);
-   
-    /*  call NDI API functionality  */
-    const NDIlib_source_t *source = NDIlib_routing_get_source_name(routing);
+    c->status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    REJECT_RETURN;
+    bool isArray = false;
+    if (argc == (size_t) 1) {
+        c->status = napi_is_array(env, args[0], &isArray);
+        REJECT_RETURN;
+    }
+    if (!isArray)
+        REJECT_ERROR_RETURN("Salvo must be given an array of changes.", GRANDIOSE_INVALID_ARGS);
+
+    Napi::Env napiEnv(env);
+    GrandioseInstanceData *instance = napiEnv.GetInstanceData<GrandioseInstanceData>();
+    Napi::Array changes = Napi::Array(env, args[0]);
+    uint32_t length = changes.Length();
+    c->changes.resize(length);
+    for (uint32_t i = 0; i < length; i++) {
+        Napi::Value entry = changes.Get(i).UnwrapOr(napiEnv.Undefined());
+        if (!entry.IsObject())
+            REJECT_ERROR_RETURN("Each salvo change must be an object with a router.", GRANDIOSE_INVALID_ARGS);
+        Napi::Value router = entry.As<Napi::Object>().Get("router").UnwrapOr(napiEnv.Undefined());
+        bool isRouting = false;
+        if (router.IsObject()) {
+            c->status = napi_instanceof(env, router, instance->routing->Value(), &isRouting);
+            REJECT_RETURN;
+        }
+        /*  an object made from the prototype alone passes instanceof but wraps nothing  */
+        GrandioseRouting *wrapped = isRouting ? GrandioseRouting::Unwrap(router.As<Napi::Object>()) : nullptr;
+        if (wrapped == nullptr)
+            REJECT_ERROR_RETURN("Each salvo change must have a router made by grandiose.routing().", GRANDIOSE_INVALID_ARGS);
+        routingState *state = wrapped->native();
+        if (state == nullptr)
+            REJECT_ERROR_RETURN("NDI routing already destroyed", GRANDIOSE_INVALID_ARGS);
+        c->changes[i].router = retainRouting(state);
+
+        Napi::Value source = entry.As<Napi::Object>().Get("source").UnwrapOr(napiEnv.Undefined());
+        if (source.IsUndefined() || source.IsNull()) {
+            c->changes[i].clear = true;
+        } else if (!parseRoutingSource(napiEnv, source, c->changes[i].name, c->changes[i].urlAddress)) {
+            napi_value error;
+            napi_get_and_clear_last_exception(env, &error);
+            napi_reject_deferred(env, c->_deferred, error);
+            tidyCarrier(env, c);
+            return promise;
+        }
+    }
 
-    /*  return a string result  */
-    napi_value result;
-    status = napi_create_string_utf8(env, source->p_ndi_name, NAPI_AUTO_LENGTH, &result);
-    CHECK_STATUS;
-   
-    return result;
-}
+    /*  queue the work on the executor  */
+    c->status = queueWork(env, c, salvoExecute, salvoComplete, c);
+    REJECT_RETURN;
 
+    return promise;
+}
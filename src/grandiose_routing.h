@@ -1,26 +1,41 @@
-/*
-**  Copyright (c) 2022 Dr. Ralf S. Engelschall <rse@engelschall.com>
-**
-**  Licensed under the Apache License, Version 2.0 (the "License");
-**  you may not use this file except in compliance with the License.
-**  You may obtain a copy of the License at
-**
-**    http://www.apache.org/licenses/LICENSE-2.0
-**
-**  Unless required by applicable law or agreed to in writing, software
-**  distributed under the License is distributed on an "AS IS" BASIS,
-**  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-**  See the License for the specific language governing permissions and
-**  limitations under the License.
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
 */
 
 #ifndef GRANDIOSE_ROUTING_H
 #define GRANDIOSE_ROUTING_H
 
+#include <atomic>
+#include <string>
+#include <vector>
 #include "node_api.h"
+#include "napi.h"
 #include "grandiose_util.h"
 
 napi_value routing(napi_env, napi_callback_info);
+napi_value routingSalvo(napi_env, napi_callback_info);
+
+/*  native NDI router, shared by its object and any salvo switching it  */
+struct routingState {
+    NDIlib_routing_instance_t routing = nullptr;
+    std::string name;
+    std::string groups;
+    std::atomic<uint32_t> refCount{1};
+};
+
+routingState* retainRouting(routingState* r);
+void releaseRouting(routingState* r);
 
 struct routingCarrier: carrier {
     char* name = nullptr;
@@ -34,5 +49,48 @@ struct routingCarrier: carrier {
     }
 };
 
-#endif /* GRANDIOSE_ROUTING_H */
+/*  one router to switch, to a source or to nothing  */
+struct salvoChange {
+    routingState* router = nullptr;
+    bool clear = false;
+    std::string name;
+    std::string urlAddress;
+    bool ok = false;
+};
+
+struct salvoCarrier: carrier {
+    std::vector<salvoChange> changes;
+    ~salvoCarrier() {
+        for (salvoChange& change : changes)
+            if (change.router != nullptr)
+                releaseRouting(change.router);
+    }
+};
+
+/*  router objects resolved by grandiose.routing()  */
+class GrandioseRouting : public Napi::ObjectWrap<GrandioseRouting> {
+public:
+    GrandioseRouting(const Napi::CallbackInfo &info);
+    static std::unique_ptr<Napi::FunctionReference> Initialize(const Napi::Env &env);
+
+    ~GrandioseRouting();
+
+    /*  nullptr once destroyed  */
+    routingState* native() { return state; }
+
+private:
+    Napi::Value Destroy(const Napi::CallbackInfo &info);
+    Napi::Value Change(const Napi::CallbackInfo &info);
+    Napi::Value Clear(const Napi::CallbackInfo &info);
+    Napi::Value Connections(const Napi::CallbackInfo &info);
+    Napi::Value SourceName(const Napi::CallbackInfo &info);
 
+    Napi::Value GetName(const Napi::CallbackInfo &info);
+    Napi::Value GetGroups(const Napi::CallbackInfo &info);
+
+    bool checkDestroyed(const Napi::Env &env);
+
+    routingState* state = nullptr;
+};
+
+#endif /* GRANDIOSE_ROUTING_H */
@@ -14,20 +14,21 @@
 */
 
 #include <cstddef>
+#include <string>
 #include <Processing.NDI.Lib.h>
 
-#ifdef _WIN32
-#ifdef _WIN64
-#pragma comment(lib, "Processing.NDI.Lib.x64.lib")
-#else // _WIN64
-#pragma comment(lib, "Processing.NDI.Lib.x86.lib")
-#endif // _WIN64
-#endif // _WIN32
-
 #include "grandiose_send.h"
 #include "grandiose_util.h"
+#include "grandiose_trace.h"
+#include "grandiose_metrics.h"
 
 napi_value videoSend(napi_env env, napi_callback_info info);
+napi_value videoSendAsync(napi_env env, napi_callback_info info);
+napi_value flushVideo(napi_env env, napi_callback_info info);
+napi_value allocFrame(napi_env env, napi_callback_info info);
+napi_value framePoolStats(napi_env env, napi_callback_info info);
+napi_value sendLatencyStats(napi_env env, napi_callback_info info);
+napi_value resetSendLatency(napi_env env, napi_callback_info info);
 napi_value audioSend(napi_env env, napi_callback_info info);
 napi_value connections(napi_env env, napi_callback_info info);
 napi_value tally(napi_env env, napi_callback_info info);
@@ -42,39 +43,241 @@ void sendExecute(napi_env env, void* data) {
   NDI_send_create_desc.p_groups = c->groups;
   NDI_send_create_desc.clock_video = c->clockVideo;
   NDI_send_create_desc.clock_audio = c->clockAudio;
-  c->send = NDIlib_send_create(&NDI_send_create_desc);
+  c->send = ndiLib->send_create(&NDI_send_create_desc);
   if (!c->send) {
     c->status = GRANDIOSE_SEND_CREATE_FAIL;
     c->errorMsg = "Failed to create NDI sender.";
     return;
   }
+  metrics.senders.fetch_add(1, std::memory_order_relaxed);
 }
 
-/*  implicit destruction of NDI sender via garbage collection  */
-void finalizeSend(napi_env env, void* data, void* hint) {
-    /*  fetch NDI sender wrapper object  */
-    napi_value obj = (napi_value)hint;
+#define FRAME_POOL_ALIGNMENT 4096
+#define FRAME_POOL_SPARES 8
+#define SENDER_SPARE_CARRIERS 8
+
+struct poolFrame {
+  framePool* pool;
+  void* data;
+  size_t size;
+  uint32_t sending = 0;
+  bool returned = false;
+};
+
+framePool* retainFramePool(framePool* p) {
+  p->refCount++;
+  return p;
+}
 
-    /*  fetch NDI sender external object  */
+void releaseFramePool(framePool* p) {
+  if (--p->refCount > 0) return;
+  for (void* spare : p->spares) {
+    alignedFree(spare);
+  }
+  delete p;
+}
+
+senderLatency* retainSenderLatency(senderLatency* l) {
+  l->refCount++;
+  return l;
+}
+
+void releaseSenderLatency(senderLatency* l) {
+  if (--l->refCount > 0) return;
+  delete l;
+}
+
+sendCarrierPool* retainSendCarrierPool(sendCarrierPool* p) {
+  p->refCount++;
+  return p;
+}
+
+void releaseSendCarrierPool(sendCarrierPool* p) {
+  if (--p->refCount > 0) return;
+  for (sendDataCarrier* spare : p->spares) {
+    delete spare;
+  }
+  delete p;
+}
+
+sendDataCarrier* acquireSendCarrier(senderState* sender) {
+  sendCarrierPool* p = sender->carriers;
+  sendDataCarrier* c;
+  if (!p->spares.empty()) {
+    c = p->spares.back();
+    p->spares.pop_back();
+  } else {
+    c = new sendDataCarrier;
+    metrics.carriersAllocated.fetch_add(1, std::memory_order_relaxed);
+  }
+  c->carriers = retainSendCarrierPool(p);
+  c->send = sender->send;
+  c->latency = retainSenderLatency(sender->latency);
+  c->queued = NOW;
+  return c;
+}
+
+/*  let go of the buffer of a send that was rejected before it completed  */
+void sendDataCarrier::releaseRefs(napi_env env) {
+  if (sourceBufferRef == nullptr) return;
+  if (pool != nullptr) {
+    releaseSentBuffer(env, pool, sourceBufferRef);
+  } else {
+    napi_delete_reference(env, sourceBufferRef);
+  }
+  sourceBufferRef = nullptr;
+}
+
+/*  reset a finished carrier, keeping it if its sender has room for a spare,
+    which holds no references that would keep the sender's state alive  */
+void recycleSendCarrier(sendDataCarrier* c) {
+  sendCarrierPool* p = c->carriers;
+  if (p == nullptr) {
+    delete c;
+    return;
+  }
+
+  if (c->pool != nullptr) {
+    releaseFramePool(c->pool);
+  }
+  if (c->latency != nullptr) {
+    releaseSenderLatency(c->latency);
+  }
+  c->pool = nullptr;
+  c->latency = nullptr;
+  c->carriers = nullptr;
+  *c = sendDataCarrier();
+
+  if (p->spares.size() < SENDER_SPARE_CARRIERS) {
+    p->spares.push_back(c);
+  } else {
+    delete c;
+  }
+  releaseSendCarrierPool(p);
+}
+
+/*  record the latencies of a send once its promise has been resolved  */
+void recordSent(sendDataCarrier* c, sendLatency& latency) {
+  latency.queue.record(std::chrono::duration_cast<std::chrono::nanoseconds>(c->sendStart - c->queued).count());
+  latency.total.recordSince(c->queued);
+}
+
+/*  take a frame of the current size, which the pool only keeps spares of  */
+void* takeFrame(framePool* p, size_t size) {
+  if (size != p->frameSize) {
+    for (void* spare : p->spares) {
+      alignedFree(spare);
+    }
+    p->spares.clear();
+    p->frameSize = size;
+  }
+  if (!p->spares.empty()) {
+    void* data = p->spares.back();
+    p->spares.pop_back();
+    p->hits++;
+    return data;
+  }
+  p->misses++;
+  return alignedAlloc(size, FRAME_POOL_ALIGNMENT);
+}
+
+/*  give a frame's memory back, once nothing in JavaScript can still reach it  */
+void returnFrame(poolFrame* frame) {
+  if (frame->returned) return;
+  frame->returned = true;
+  framePool* p = frame->pool;
+  p->outstanding.erase(frame->data);
+  if (frame->size == p->frameSize && p->spares.size() < FRAME_POOL_SPARES) {
+    p->spares.push_back(frame->data);
+    p->recycled++;
+  } else {
+    alignedFree(frame->data);
+  }
+}
+
+void finalizePoolFrame(napi_env env, void* data, void* hint) {
+  poolFrame* frame = (poolFrame*) hint;
+  returnFrame(frame);
+  int64_t adjusted;
+  napi_adjust_external_memory(env, -(int64_t)frame->size, &adjusted);
+  releaseFramePool(frame->pool);
+  delete frame;
+}
+
+/*  note that a send is reading from a buffer, if it is one of the pool's frames  */
+void holdSentBuffer(framePool* p, void* data) {
+  auto found = p->outstanding.find(data);
+  if (found != p->outstanding.end()) {
+    found->second->sending++;
+  }
+}
+
+void releaseSentBuffer(napi_env env, framePool* p, napi_ref buffer) {
+  napi_value value;
+  if (napi_get_reference_value(env, buffer, &value) == napi_ok && value != nullptr) {
+    napi_typedarray_type type;
+    size_t length, offset;
+    void* data;
+    napi_value arrayBuffer;
+    if (napi_get_typedarray_info(env, value, &type, &length, &data, &arrayBuffer, &offset) == napi_ok) {
+      auto found = p->outstanding.find(data);
+      /*  a frame is only reused once no send reads from it and its buffer
+          can no longer write to it  */
+      if (found != p->outstanding.end() && --found->second->sending == 0 &&
+          offset == 0 && napi_detach_arraybuffer(env, arrayBuffer) == napi_ok) {
+        returnFrame(found->second);
+      }
+    }
+  }
+  napi_delete_reference(env, buffer);
+}
+
+/*  fetch the native state of an NDI sender wrapper object  */
+napi_status getSender(napi_env env, napi_value sender, senderState** result) {
+    napi_status status;
     napi_value sendValue;
-    if (napi_get_named_property(env, obj, "embedded", &sendValue) != napi_ok)
-        return;
+    status = napi_get_named_property(env, sender, "embedded", &sendValue);
+    PASS_STATUS;
+    void* sendData;
+    status = napi_get_value_external(env, sendValue, &sendData);
+    PASS_STATUS;
+    *result = (senderState*) sendData;
+    return napi_ok;
+}
 
-    /*  ensure it was still not manually destroyed  */
-    napi_valuetype result;
-    if (napi_typeof(env, sendValue, &result) != napi_ok)
-        return;
-    if (result != napi_external)
-        return;
+/*  destroy the NDI sender, after which NDI no longer reads any pinned buffer  */
+void destroySender(napi_env env, senderState* s) {
+    if (s->send != nullptr) {
+        ndiLib->send_destroy(s->send);
+        s->send = nullptr;
+        metrics.senders.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (s->pinnedVideo != nullptr) {
+        releaseSentBuffer(env, s->pool, s->pinnedVideo);
+        s->pinnedVideo = nullptr;
+    }
+}
 
-    /*  fetch NDI sender native object  */
-    void *sendData;
-    if (napi_get_value_external(env, sendValue, &sendData) != napi_ok)
-        return;
-    NDIlib_send_instance_t send = (NDIlib_send_instance_t)sendData;
+senderState* retainSender(senderState* s) {
+    s->refCount.fetch_add(1, std::memory_order_relaxed);
+    return s;
+}
 
-    /*  call the NDI API  */
-    NDIlib_send_destroy(send);
+void releaseSender(napi_env env, senderState* s) {
+    if (s->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        /*  a sender destroyed manually has nothing left but its state  */
+        destroySender(env, s);
+        releaseFramePool(s->pool);
+        releaseSenderLatency(s->latency);
+        releaseSendCarrierPool(s->carriers);
+        delete s;
+    }
+}
+
+/*  implicit destruction of NDI sender via garbage collection, once no relay
+    holds it (finalizers run in no fixed order at environment teardown)  */
+void finalizeSend(napi_env env, void* data, void* hint) {
+    releaseSender(env, (senderState*) data);
 }
 
 /*  explicit destruction of NDI sender via "destroy" method  */
@@ -106,14 +309,16 @@ napi_value destroySend(napi_env env, napi_callback_info info) {
         void *sendData;
         c->status = napi_get_value_external(env, sendValue, &sendData);
         REJECT_RETURN;
-        NDIlib_send_instance_t send = (NDIlib_send_instance_t)sendData;
+        if (((senderState*) sendData)->relays > 0) REJECT_ERROR_RETURN(
+          "Stop the relays sending through this sender before destroying it.",
+          GRANDIOSE_INVALID_ARGS);
 
-        /*  call the NDI API  */
-        NDIlib_send_destroy(send);
+        /*  call the NDI API, leaving the state for "finalizeSend"  */
+        destroySender(env, (senderState*) sendData);
 
         /*  overwrite the "embedded" field with a non-external value
-            (to ensure that the "finalizeSend" will no longer do anything
-            once the garbage collection fires)  */
+            (to ensure that later calls fail, while "finalizeSend" only
+            frees the state once the garbage collection fires)  */
         napi_value value;
         napi_create_int32(env, 0, &value);
         c->status = napi_set_named_property(env, thisValue, "embedded", value);
@@ -140,8 +345,13 @@ void sendComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_create_object(env, &result);
   REJECT_STATUS;
 
+  senderState* state = new senderState;
+  state->send = c->send;
   napi_value embedded;
-  c->status = napi_create_external(env, c->send, finalizeSend, result, &embedded);
+  c->status = napi_create_external(env, state, finalizeSend, nullptr, &embedded);
+  if (c->status != napi_ok) {
+    delete state;
+  }
   REJECT_STATUS;
   c->status = napi_set_named_property(env, result, "embedded", embedded);
   REJECT_STATUS;
@@ -160,6 +370,48 @@ void sendComplete(napi_env env, napi_status asyncStatus, void* data) {
   c->status = napi_set_named_property(env, result, "video", videoFn);
   REJECT_STATUS;
 
+  napi_value videoAsyncFn;
+  c->status = napi_create_function(env, "videoAsync", NAPI_AUTO_LENGTH, videoSendAsync,
+    nullptr, &videoAsyncFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "videoAsync", videoAsyncFn);
+  REJECT_STATUS;
+
+  napi_value flushVideoFn;
+  c->status = napi_create_function(env, "flushVideo", NAPI_AUTO_LENGTH, flushVideo,
+    nullptr, &flushVideoFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "flushVideo", flushVideoFn);
+  REJECT_STATUS;
+
+  napi_value allocFrameFn;
+  c->status = napi_create_function(env, "allocFrame", NAPI_AUTO_LENGTH, allocFrame,
+    nullptr, &allocFrameFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "allocFrame", allocFrameFn);
+  REJECT_STATUS;
+
+  napi_value framePoolStatsFn;
+  c->status = napi_create_function(env, "framePoolStats", NAPI_AUTO_LENGTH, framePoolStats,
+    nullptr, &framePoolStatsFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "framePoolStats", framePoolStatsFn);
+  REJECT_STATUS;
+
+  napi_value latencyFn;
+  c->status = napi_create_function(env, "latency", NAPI_AUTO_LENGTH, sendLatencyStats,
+    nullptr, &latencyFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "latency", latencyFn);
+  REJECT_STATUS;
+
+  napi_value resetLatencyFn;
+  c->status = napi_create_function(env, "resetLatency", NAPI_AUTO_LENGTH, resetSendLatency,
+    nullptr, &resetLatencyFn);
+  REJECT_STATUS;
+  c->status = napi_set_named_property(env, result, "resetLatency", resetLatencyFn);
+  REJECT_STATUS;
+
   napi_value audioFn;
   c->status = napi_create_function(env, "audio", NAPI_AUTO_LENGTH, audioSend,
     nullptr, &audioFn);
@@ -234,6 +486,9 @@ napi_value send(napi_env env, napi_callback_info info) {
   c->status = napi_create_promise(env, &c->_deferred, &promise);
   REJECT_RETURN;
 
+  std::string error;
+  if (!loadNdi(error)) REJECT_ERROR_RETURN(error, GRANDIOSE_NDI_LOAD_FAIL);
+
   size_t argc = 1;
   napi_value args[1];
   c->status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
@@ -303,155 +558,110 @@ napi_value send(napi_env env, napi_callback_info info) {
     REJECT_RETURN;
   }
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "Send", NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, sendExecute,
-    sendComplete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  c->status = queueWork(env, c, sendExecute, sendComplete, c);
   REJECT_RETURN;
 
   return promise;
 }
 
 
-void videoSendExecute(napi_env env, void* data) {
-  sendDataCarrier* c = (sendDataCarrier*) data;
-
-  NDIlib_send_send_video_v2(c->send, &c->videoFrame);
-}
-
-void videoSendComplete(napi_env env, napi_status asyncStatus, void* data) {
-  sendDataCarrier* c = (sendDataCarrier*) data;
-  napi_value result;
-  napi_status status;
-
-  c->status = napi_delete_reference(env, c->sourceBufferRef);
-  REJECT_STATUS;
-
-  if (asyncStatus != napi_ok) {
-    c->status = asyncStatus;
-    c->errorMsg = "Async video frame receive failed to complete.";
-  }
-  REJECT_STATUS;
-
-  c->status = napi_create_object(env, &result);
-  REJECT_STATUS;
-  status = napi_resolve_deferred(env, c->_deferred, result);
-  FLOATING_STATUS;
-
-  tidyCarrier(env, c);
+/*  variants of REJECT_RETURN and REJECT_ERROR_RETURN for parsing into a
+    carrier that is not necessarily backing a promise  */
+#define PARSE_STATUS if (c->status != GRANDIOSE_SUCCESS) return
+#define PARSE_ERROR(msg, stat) { \
+  c->errorMsg = msg; \
+  c->status = stat; \
+  return; \
 }
 
-napi_value videoSend(napi_env env, napi_callback_info info) {
+/*  parse a video frame object, leaving the buffer that holds its data  */
+void videoFrameFromJs(napi_env env, napi_value config, sendDataCarrier* c, napi_value* buffer) {
   napi_valuetype type;
-  sendDataCarrier* c = new sendDataCarrier;
 
-  napi_value promise;
-  c->status = napi_create_promise(env, &c->_deferred, &promise);
-  REJECT_RETURN;
-
-  size_t argc = 1;
-  napi_value args[1];
-  napi_value thisValue;
-  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-  REJECT_RETURN;
-
-  napi_value sendValue;
-  c->status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
-  REJECT_RETURN;
-  void* sendData;
-  c->status = napi_get_value_external(env, sendValue, &sendData);
-  c->send = (NDIlib_send_instance_t) sendData;
-  REJECT_RETURN;
-
-  if (argc >= 1) {
-    napi_value config;
-    config = args[0];
+  {
     c->status = napi_typeof(env, config, &type);
-    REJECT_RETURN;
-    if (type != napi_object) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (type != napi_object) PARSE_ERROR(
       "frame must be an object",
       GRANDIOSE_INVALID_ARGS);
 
     bool isArray, isBuffer;
     c->status = napi_is_array(env, config, &isArray);
-    REJECT_RETURN;
-    if (isArray) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (isArray) PARSE_ERROR(
       "Argument to video send cannot be an array.",
       GRANDIOSE_INVALID_ARGS);
 
     napi_value param;
     c->status = napi_get_named_property(env, config, "xres", &param);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (type != napi_number) PARSE_ERROR(
       "yres value must be a number",
       GRANDIOSE_INVALID_ARGS);
     c->status = napi_get_value_int32(env, param, &c->videoFrame.xres);
-    REJECT_RETURN;
+    PARSE_STATUS;
 
     c->status = napi_get_named_property(env, config, "yres", &param);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (type != napi_number) PARSE_ERROR(
       "yres value must be a number",
       GRANDIOSE_INVALID_ARGS);
     c->status = napi_get_value_int32(env, param, &c->videoFrame.yres);
-    REJECT_RETURN;
+    PARSE_STATUS;
 
     c->status = napi_get_named_property(env, config, "frameRateN", &param);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (type != napi_number) PARSE_ERROR(
       "frameRateN value must be a number",
       GRANDIOSE_INVALID_ARGS);
     c->status = napi_get_value_int32(env, param, &c->videoFrame.frame_rate_N);
-    REJECT_RETURN;
+    PARSE_STATUS;
 
     c->status = napi_get_named_property(env, config, "frameRateD", &param);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (type != napi_number) PARSE_ERROR(
       "frameRateD value must be a number",
       GRANDIOSE_INVALID_ARGS);
     c->status = napi_get_value_int32(env, param, &c->videoFrame.frame_rate_D);
-    REJECT_RETURN;
+    PARSE_STATUS;
 
     c->status = napi_get_named_property(env, config, "pictureAspectRatio", &param);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (type != napi_number) PARSE_ERROR(
       "pictureAspectRatio value must be a number",
       GRANDIOSE_INVALID_ARGS);
     double pictureAspectRatio;
     c->status = napi_get_value_double(env, param, &pictureAspectRatio);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->videoFrame.picture_aspect_ratio = (float) pictureAspectRatio;
 
     c->videoFrame.timecode = NDIlib_send_timecode_synthesize;
     c->status = napi_get_named_property(env, config, "timecode", &param);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
+    PARSE_STATUS;
     if (type != napi_undefined) {
         if (type == napi_number) {
             c->status = napi_get_value_int64(env, param, &c->videoFrame.timecode);
-            REJECT_RETURN;
+            PARSE_STATUS;
         }
         else if (type == napi_bigint) {
             bool lossless;
             c->status = napi_get_value_bigint_int64(env, param, &c->videoFrame.timecode, &lossless);
-            REJECT_RETURN;
+            PARSE_STATUS;
         }
         else
-            REJECT_ERROR_RETURN("timecode value must be a number or bigint", GRANDIOSE_INVALID_ARGS);
+            PARSE_ERROR("timecode value must be a number or bigint", GRANDIOSE_INVALID_ARGS);
     }
 
     /*  initialize also timestamp (receiver-side only) and metadata  */
@@ -459,87 +669,466 @@ napi_value videoSend(napi_env env, napi_callback_info info) {
     c->videoFrame.p_metadata = NULL;
 
     c->status = napi_get_named_property(env, config, "frameFormatType", &param);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (type != napi_number) PARSE_ERROR(
       "frameFormatType value must be a number",
       GRANDIOSE_INVALID_ARGS);
     int32_t formatType;
     c->status = napi_get_value_int32(env, param, &formatType);
-    REJECT_RETURN;
+    PARSE_STATUS;
     // TODO: checks
     c->videoFrame.frame_format_type = (NDIlib_frame_format_type_e) formatType;
 
     c->status = napi_get_named_property(env, config, "lineStrideBytes", &param);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (type != napi_number) PARSE_ERROR(
       "lineStrideBytes value must be a number",
       GRANDIOSE_INVALID_ARGS);
     c->status = napi_get_value_int32(env, param, &c->videoFrame.line_stride_in_bytes);
-    REJECT_RETURN;
+    PARSE_STATUS;
 
     napi_value videoBuffer;
     c->status = napi_get_named_property(env, config, "data", &videoBuffer);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->status = napi_is_buffer(env, videoBuffer, &isBuffer);
-    REJECT_RETURN;
-    if (!isBuffer) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (!isBuffer) PARSE_ERROR(
       "data must be provided as a Node Buffer",
       GRANDIOSE_INVALID_ARGS);
     void * data;
     size_t length;
     c->status = napi_get_buffer_info(env, videoBuffer, &data, &length);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->videoFrame.p_data = (uint8_t*) data;
-    c->status = napi_create_reference(env, videoBuffer, 1, &c->sourceBufferRef);
-    REJECT_RETURN;
-    // TODO: check length
-
+    *buffer = videoBuffer;
 
     c->status = napi_get_named_property(env, config, "fourCC", &param);
-    REJECT_RETURN;
+    PARSE_STATUS;
     c->status = napi_typeof(env, param, &type);
-    REJECT_RETURN;
-    if (type != napi_number) REJECT_ERROR_RETURN(
+    PARSE_STATUS;
+    if (type != napi_number) PARSE_ERROR(
       "fourCC value must be a number",
       GRANDIOSE_INVALID_ARGS);
     int32_t fourCC;
     c->status = napi_get_value_int32(env, param, &fourCC);
-    REJECT_RETURN;
+    PARSE_STATUS;
     // TODO: checks
     c->videoFrame.FourCC = (NDIlib_FourCC_video_type_e) fourCC; // TODO
 
+    /*  NDI reads a whole frame from the buffer, after the call returns for
+        asynchronous sends  */
+    size_t frameSize = videoFrameSize(c->videoFrame.FourCC, c->videoFrame.xres,
+      c->videoFrame.yres, c->videoFrame.line_stride_in_bytes);
+    if (length < frameSize) PARSE_ERROR(
+      "data is too short for the frame's fourCC, resolution and lineStrideBytes",
+      GRANDIOSE_INVALID_ARGS);
+  }
+}
+
+void videoSendExecute(napi_env env, void* data) {
+  sendDataCarrier* c = (sendDataCarrier*) data;
+  traceScope span(TRACE_SEND, "videoSendExecute");
+  traceFlowStart(TRACE_SEND, "videoSend", c);
+
+  c->sendStart = NOW;
+  ndiLib->send_send_video_v2(c->send, &c->videoFrame);
+  c->latency->video.send.recordSince(c->sendStart);
+  metrics.sendDuration[METRIC_VIDEO].recordSince(c->sendStart);
+  countFrame(metrics.framesSent, metrics.bytesSent, METRIC_VIDEO, videoFrameBytes(c->videoFrame));
+}
+
+void videoSendComplete(napi_env env, napi_status asyncStatus, void* data) {
+  sendDataCarrier* c = (sendDataCarrier*) data;
+  traceScope span(TRACE_SEND, "videoSendComplete");
+  traceFlowEnd(TRACE_SEND, "videoSend", c);
+  napi_value result;
+  napi_status status;
+
+  releaseSentBuffer(env, c->pool, c->sourceBufferRef);
+  c->sourceBufferRef = nullptr;
+
+  if (asyncStatus != napi_ok) {
+    c->status = asyncStatus;
+    c->errorMsg = "Async video frame receive failed to complete.";
+  }
+  REJECT_STATUS;
+
+  c->status = napi_create_object(env, &result);
+  REJECT_STATUS;
+  status = napi_resolve_deferred(env, c->_deferred, result);
+  FLOATING_STATUS;
+  recordSent(c, c->latency->video);
+
+  tidyCarrier(env, c);
+}
+
+napi_value videoSend(napi_env env, napi_callback_info info) {
+  traceScope span(TRACE_SEND, "videoSend");
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  senderState* sender = nullptr;
+  napi_status status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  if (status == napi_ok) status = getSender(env, thisValue, &sender);
+  /*  without a sender, a carrier is made just to reject with  */
+  sendDataCarrier* c = sender != nullptr ? acquireSendCarrier(sender) : new sendDataCarrier;
+
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
+  REJECT_RETURN;
+  if (sender == nullptr) REJECT_ERROR_RETURN(
+    "Video send must be called on a sender.",
+    GRANDIOSE_INVALID_ARGS);
+  if (sender->relays > 0) REJECT_ERROR_RETURN(
+    "Video cannot be sent while a relay is sending through this sender.",
+    GRANDIOSE_INVALID_ARGS);
+  c->pool = retainFramePool(sender->pool);
+
+  if (argc >= 1) {
+    napi_value videoBuffer;
+    videoFrameFromJs(env, args[0], c, &videoBuffer);
+    REJECT_RETURN;
+    c->status = napi_create_reference(env, videoBuffer, 1, &c->sourceBufferRef);
+    REJECT_RETURN;
+    holdSentBuffer(c->pool, c->videoFrame.p_data);
   } else REJECT_ERROR_RETURN(
       "frame not provided",
     GRANDIOSE_INVALID_ARGS);
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "VideoSend", NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, videoSendExecute,
-    videoSendComplete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  c->status = queueWork(env, c, videoSendExecute, videoSendComplete, c);
   REJECT_RETURN;
 
   return promise;
 }
 
+/*  throw the error recorded in a carrier, as rejectStatus would reject with it  */
+napi_value throwCarrierError(napi_env env, carrier* c) {
+  if (c->status < GRANDIOSE_ERROR_START) {
+    const napi_extended_error_info *errorInfo;
+    napi_get_last_error_info(env, &errorInfo);
+    c->errorMsg = std::string(errorInfo->error_message);
+  }
+  napi_throw_error(env, std::to_string(c->status).c_str(), c->errorMsg.c_str());
+  return nullptr;
+}
+
+/*  replace the buffer pinned for NDI, which lets go of the previous frame  */
+void pinVideo(napi_env env, senderState* sender, napi_ref buffer) {
+  if (sender->pinnedVideo != nullptr) {
+    releaseSentBuffer(env, sender->pool, sender->pinnedVideo);
+  }
+  sender->pinnedVideo = buffer;
+}
+
+/*  send a video frame without leaving the JavaScript thread, NDI reading from
+    its buffer until the next call or a flush  */
+napi_value videoSendAsync(napi_env env, napi_callback_info info) {
+  traceScope span(TRACE_SEND, "videoSendAsync");
+  sendDataCarrier c;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  c.status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  if (c.status != napi_ok) return throwCarrierError(env, &c);
+
+  senderState* sender;
+  c.status = getSender(env, thisValue, &sender);
+  if (c.status != napi_ok) return throwCarrierError(env, &c);
+  /*  a second thread sending would end the relay's frame in flight  */
+  if (sender->relays > 0) {
+    c.status = GRANDIOSE_INVALID_ARGS;
+    c.errorMsg = "Video cannot be sent while a relay is sending through this sender.";
+    return throwCarrierError(env, &c);
+  }
+
+  if (argc < 1) {
+    c.status = GRANDIOSE_INVALID_ARGS;
+    c.errorMsg = "frame not provided";
+    return throwCarrierError(env, &c);
+  }
+  napi_value videoBuffer;
+  videoFrameFromJs(env, args[0], &c, &videoBuffer);
+  if (c.status != GRANDIOSE_SUCCESS) return throwCarrierError(env, &c);
+
+  napi_ref bufferRef;
+  c.status = napi_create_reference(env, videoBuffer, 1, &bufferRef);
+  if (c.status != napi_ok) return throwCarrierError(env, &c);
+
+  /*  NDI has finished with the previous buffer once this returns  */
+  holdSentBuffer(sender->pool, c.videoFrame.p_data);
+  HR_TIME_POINT start = NOW;
+  ndiLib->send_send_video_async_v2(sender->send, &c.videoFrame);
+  sender->latency->video.send.recordSince(start);
+  metrics.sendDuration[METRIC_VIDEO].recordSince(start);
+  countFrame(metrics.framesSent, metrics.bytesSent, METRIC_VIDEO, videoFrameBytes(c.videoFrame));
+  pinVideo(env, sender, bufferRef);
+
+  napi_value undefined;
+  napi_get_undefined(env, &undefined);
+  return undefined;
+}
+
+/*  wait for NDI to finish with the last asynchronously sent frame  */
+napi_value flushVideo(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  senderState* sender;
+  status = getSender(env, thisValue, &sender);
+  CHECK_STATUS;
+  if (sender->relays > 0) {
+    carrier c;
+    c.status = GRANDIOSE_INVALID_ARGS;
+    c.errorMsg = "Video cannot be sent while a relay is sending through this sender.";
+    return throwCarrierError(env, &c);
+  }
+
+  ndiLib->send_send_video_async_v2(sender->send, nullptr);
+  pinVideo(env, sender, nullptr);
+
+  napi_value undefined;
+  napi_get_undefined(env, &undefined);
+  return undefined;
+}
+
+/*  bytes in a frame of the given format, or zero if it is not known  */
+size_t videoFrameSize(NDIlib_FourCC_video_type_e fourCC, int32_t xres, int32_t yres, int32_t lineStride) {
+  size_t x = (size_t) xres, y = (size_t) yres;
+  switch (fourCC) {
+    case NDIlib_FourCC_video_type_UYVY:
+      return (lineStride > 0 ? (size_t) lineStride : x * 2) * y;
+    case NDIlib_FourCC_video_type_UYVA:
+      return (lineStride > 0 ? (size_t) lineStride : x * 2) * y + x * y;
+    case NDIlib_FourCC_video_type_P216:
+      return (lineStride > 0 ? (size_t) lineStride : x * 2) * y * 2;
+    case NDIlib_FourCC_video_type_PA16:
+      return (lineStride > 0 ? (size_t) lineStride : x * 2) * y * 3;
+    case NDIlib_FourCC_video_type_YV12:
+    case NDIlib_FourCC_video_type_I420:
+    case NDIlib_FourCC_video_type_NV12:
+      return (lineStride > 0 ? (size_t) lineStride : x) * y * 3 / 2;
+    case NDIlib_FourCC_video_type_BGRA:
+    case NDIlib_FourCC_video_type_BGRX:
+    case NDIlib_FourCC_video_type_RGBA:
+    case NDIlib_FourCC_video_type_RGBX:
+      return (lineStride > 0 ? (size_t) lineStride : x * 4) * y;
+    default:
+      return 0;
+  }
+}
+
+/*  hand out a frame buffer from the sender's pool, which goes back to the pool
+    once a video send has finished with it  */
+napi_value allocFrame(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_valuetype type;
+
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  senderState* sender;
+  status = getSender(env, thisValue, &sender);
+  CHECK_STATUS;
+
+  if (argc < 1) NAPI_THROW_ERROR("Frame format must be provided as an object.");
+  status = napi_typeof(env, args[0], &type);
+  CHECK_STATUS;
+  if (type != napi_object) NAPI_THROW_ERROR("Frame format must be provided as an object.");
+
+  int32_t xres, yres, fourCC, lineStride = 0;
+  napi_value param;
+  status = napi_get_named_property(env, args[0], "xres", &param);
+  CHECK_STATUS;
+  if (napi_get_value_int32(env, param, &xres) != napi_ok || xres <= 0)
+    NAPI_THROW_ERROR("xres value must be a positive number");
+  status = napi_get_named_property(env, args[0], "yres", &param);
+  CHECK_STATUS;
+  if (napi_get_value_int32(env, param, &yres) != napi_ok || yres <= 0)
+    NAPI_THROW_ERROR("yres value must be a positive number");
+  status = napi_get_named_property(env, args[0], "fourCC", &param);
+  CHECK_STATUS;
+  if (napi_get_value_int32(env, param, &fourCC) != napi_ok)
+    NAPI_THROW_ERROR("fourCC value must be a number");
+  status = napi_get_named_property(env, args[0], "lineStrideBytes", &param);
+  CHECK_STATUS;
+  status = napi_typeof(env, param, &type);
+  CHECK_STATUS;
+  if (type != napi_undefined && napi_get_value_int32(env, param, &lineStride) != napi_ok)
+    NAPI_THROW_ERROR("lineStrideBytes value must be a number");
+
+  size_t size = videoFrameSize((NDIlib_FourCC_video_type_e) fourCC, xres, yres, lineStride);
+  if (size == 0) NAPI_THROW_ERROR("Unsupported fourCC for a pooled frame.");
+
+  framePool* pool = sender->pool;
+  void* data = takeFrame(pool, size);
+  if (data == nullptr) NAPI_THROW_ERROR("Failed to allocate memory for a video frame.");
+
+  poolFrame* frame = new poolFrame{ retainFramePool(pool), data, size };
+  napi_value result;
+  status = napi_create_external_buffer(env, size, data, finalizePoolFrame, frame, &result);
+  if (status != napi_ok) {
+    /*  runtimes without external buffers get a plain buffer, outside the pool  */
+    returnFrame(frame);
+    releaseFramePool(pool);
+    delete frame;
+    status = napi_create_buffer(env, size, nullptr, &result);
+    CHECK_STATUS;
+    return result;
+  }
+  pool->outstanding[data] = frame;
+  int64_t adjusted;
+  napi_adjust_external_memory(env, (int64_t) size, &adjusted);
+
+  return result;
+}
+
+napi_value framePoolStats(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  senderState* sender;
+  status = getSender(env, thisValue, &sender);
+  CHECK_STATUS;
+  framePool* pool = sender->pool;
+
+  napi_value result, value;
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+  status = napi_create_int64(env, (int64_t) pool->hits, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "hits", value);
+  CHECK_STATUS;
+  status = napi_create_int64(env, (int64_t) pool->misses, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "misses", value);
+  CHECK_STATUS;
+  status = napi_create_int64(env, (int64_t) pool->recycled, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "recycled", value);
+  CHECK_STATUS;
+  status = napi_create_int64(env, (int64_t) pool->spares.size(), &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "spare", value);
+  CHECK_STATUS;
+  status = napi_create_int64(env, (int64_t) pool->outstanding.size(), &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "outstanding", value);
+  CHECK_STATUS;
+  status = napi_create_int64(env, (int64_t) pool->frameSize, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "frameSize", value);
+  CHECK_STATUS;
+
+  return result;
+}
+
+napi_status sendLatencyToJs(napi_env env, sendLatency& latency, napi_value* result) {
+  napi_status status;
+  napi_value value;
+
+  status = napi_create_object(env, result);
+  PASS_STATUS;
+  status = histogramToJs(env, latency.queue, &value);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "queue", value);
+  PASS_STATUS;
+  status = histogramToJs(env, latency.send, &value);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "send", value);
+  PASS_STATUS;
+  status = histogramToJs(env, latency.total, &value);
+  PASS_STATUS;
+  status = napi_set_named_property(env, *result, "total", value);
+  PASS_STATUS;
+
+  return napi_ok;
+}
+
+napi_value sendLatencyStats(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  senderState* sender;
+  status = getSender(env, thisValue, &sender);
+  CHECK_STATUS;
+
+  napi_value result, value;
+  status = napi_create_object(env, &result);
+  CHECK_STATUS;
+  status = sendLatencyToJs(env, sender->latency->video, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "video", value);
+  CHECK_STATUS;
+  status = sendLatencyToJs(env, sender->latency->audio, &value);
+  CHECK_STATUS;
+  status = napi_set_named_property(env, result, "audio", value);
+  CHECK_STATUS;
+
+  return result;
+}
+
+napi_value resetSendLatency(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  napi_value thisValue;
+  status = napi_get_cb_info(env, info, nullptr, nullptr, &thisValue, nullptr);
+  CHECK_STATUS;
+
+  senderState* sender;
+  status = getSender(env, thisValue, &sender);
+  CHECK_STATUS;
+
+  for (sendLatency* latency : { &sender->latency->video, &sender->latency->audio }) {
+    latency->queue.reset();
+    latency->send.reset();
+    latency->total.reset();
+  }
+
+  napi_value result;
+  status = napi_get_undefined(env, &result);
+  CHECK_STATUS;
+  return result;
+}
+
 void audioSendExecute(napi_env env, void* data) {
   sendDataCarrier* c = (sendDataCarrier*) data;
-
-  NDIlib_send_send_audio_v3(c->send, &c->audioFrame);
+  traceScope span(TRACE_SEND, "audioSendExecute");
+  traceFlowStart(TRACE_SEND, "audioSend", c);
+
+  c->sendStart = NOW;
+  ndiLib->send_send_audio_v3(c->send, &c->audioFrame);
+  c->latency->audio.send.recordSince(c->sendStart);
+  metrics.sendDuration[METRIC_AUDIO].recordSince(c->sendStart);
+  countFrame(metrics.framesSent, metrics.bytesSent, METRIC_AUDIO, audioFrameBytes(c->audioFrame));
 }
 
 void audioSendComplete(napi_env env, napi_status asyncStatus, void* data) {
   sendDataCarrier* c = (sendDataCarrier*) data;
+  traceScope span(TRACE_SEND, "audioSendComplete");
+  traceFlowEnd(TRACE_SEND, "audioSend", c);
   napi_value result;
   napi_status status;
 
   c->status = napi_delete_reference(env, c->sourceBufferRef);
+  c->sourceBufferRef = nullptr;
   REJECT_STATUS;
 
   if (asyncStatus != napi_ok) {
@@ -552,31 +1141,30 @@ void audioSendComplete(napi_env env, napi_status asyncStatus, void* data) {
   REJECT_STATUS;
   status = napi_resolve_deferred(env, c->_deferred, result);
   FLOATING_STATUS;
+  recordSent(c, c->latency->audio);
 
   tidyCarrier(env, c);
 }
 
 napi_value audioSend(napi_env env, napi_callback_info info) {
+  traceScope span(TRACE_SEND, "audioSend");
   napi_valuetype type;
-  sendDataCarrier* c = new sendDataCarrier;
-
-  napi_value promise;
-  c->status = napi_create_promise(env, &c->_deferred, &promise);
-  REJECT_RETURN;
 
   size_t argc = 1;
   napi_value args[1];
   napi_value thisValue;
-  c->status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
-  REJECT_RETURN;
+  senderState* sender = nullptr;
+  napi_status status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
+  if (status == napi_ok) status = getSender(env, thisValue, &sender);
+  /*  without a sender, a carrier is made just to reject with  */
+  sendDataCarrier* c = sender != nullptr ? acquireSendCarrier(sender) : new sendDataCarrier;
 
-  napi_value sendValue;
-  c->status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
-  REJECT_RETURN;
-  void* sendData;
-  c->status = napi_get_value_external(env, sendValue, &sendData);
-  c->send = (NDIlib_send_instance_t) sendData;
+  napi_value promise;
+  c->status = napi_create_promise(env, &c->_deferred, &promise);
   REJECT_RETURN;
+  if (sender == nullptr) REJECT_ERROR_RETURN(
+    "Audio send must be called on a sender.",
+    GRANDIOSE_INVALID_ARGS);
 
   if (argc >= 1) {
     napi_value config;
@@ -690,13 +1278,7 @@ napi_value audioSend(napi_env env, napi_callback_info info) {
       "frame not provided",
     GRANDIOSE_INVALID_ARGS);
 
-  napi_value resource_name;
-  c->status = napi_create_string_utf8(env, "AudioSend", NAPI_AUTO_LENGTH, &resource_name);
-  REJECT_RETURN;
-  c->status = napi_create_async_work(env, NULL, resource_name, audioSendExecute,
-    audioSendComplete, c, &c->_request);
-  REJECT_RETURN;
-  c->status = napi_queue_async_work(env, c->_request);
+  c->status = queueWork(env, c, audioSendExecute, audioSendComplete, c);
   REJECT_RETURN;
 
   return promise;
@@ -711,15 +1293,12 @@ napi_value connections(napi_env env, napi_callback_info info) {
   status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
   CHECK_STATUS;
 
-  napi_value sendValue;
-  status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
-  CHECK_STATUS;
-  void *sendData;
-  status = napi_get_value_external(env, sendValue, &sendData);
+  senderState *state;
+  status = getSender(env, thisValue, &state);
   CHECK_STATUS;
-  NDIlib_send_instance_t sender = (NDIlib_send_instance_t)sendData;
+  NDIlib_send_instance_t sender = state->send;
 
-  int conns = NDIlib_send_get_no_connections(sender, 0);
+  int conns = ndiLib->send_get_no_connections(sender, 0);
   napi_value result;
   status = napi_create_int32(env, (int32_t)conns, &result);
   CHECK_STATUS;
@@ -736,16 +1315,13 @@ napi_value tally(napi_env env, napi_callback_info info) {
   status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
   CHECK_STATUS;
 
-  napi_value sendValue;
-  status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
+  senderState *state;
+  status = getSender(env, thisValue, &state);
   CHECK_STATUS;
-  void *sendData;
-  status = napi_get_value_external(env, sendValue, &sendData);
-  CHECK_STATUS;
-  NDIlib_send_instance_t sender = (NDIlib_send_instance_t)sendData;
+  NDIlib_send_instance_t sender = state->send;
 
   NDIlib_tally_t tally;
-  bool changed = NDIlib_send_get_tally(sender, &tally, 0);
+  bool changed = ndiLib->send_get_tally(sender, &tally, 0);
 
   napi_value result;
   status = napi_create_object(env, &result);
@@ -774,15 +1350,12 @@ napi_value sourcename(napi_env env, napi_callback_info info) {
   status = napi_get_cb_info(env, info, &argc, args, &thisValue, nullptr);
   CHECK_STATUS;
 
-  napi_value sendValue;
-  status = napi_get_named_property(env, thisValue, "embedded", &sendValue);
-  CHECK_STATUS;
-  void *sendData;
-  status = napi_get_value_external(env, sendValue, &sendData);
+  senderState *state;
+  status = getSender(env, thisValue, &state);
   CHECK_STATUS;
-  NDIlib_send_instance_t sender = (NDIlib_send_instance_t)sendData;
+  NDIlib_send_instance_t sender = state->send;
 
-  const NDIlib_source_t *source = NDIlib_send_get_source_name(sender);
+  const NDIlib_source_t *source = ndiLib->send_get_source_name(sender);
   napi_value result;
   status = napi_create_string_utf8(env, source->p_ndi_name, NAPI_AUTO_LENGTH, &result);
   CHECK_STATUS;
@@ -16,11 +16,93 @@
 #ifndef GRANDIOSE_SEND_H
 #define GRANDIOSE_SEND_H
 
+#include <atomic>
+#include <unordered_map>
+#include <vector>
 #include "node_api.h"
 #include "grandiose_util.h"
+#include "grandiose_histogram.h"
 
 napi_value send(napi_env env, napi_callback_info info);
 
+struct poolFrame;
+
+// Page-aligned video frames handed out by sender.allocFrame() and reused once
+// NDI has finished sending them. Only touched on the JavaScript thread, except
+// that sends abandoned by the executor release their references elsewhere.
+struct framePool {
+  size_t frameSize = 0;
+  std::vector<void*> spares;
+  std::unordered_map<void*, poolFrame*> outstanding;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t recycled = 0;
+  std::atomic<uint32_t> refCount{1};
+};
+
+framePool* retainFramePool(framePool* p);
+void releaseFramePool(framePool* p);
+// Drop a reference to a sent buffer, returning it to the pool if it came from there
+void releaseSentBuffer(napi_env env, framePool* p, napi_ref buffer);
+
+// Time taken by frames of one type sent through a sender
+struct sendLatency {
+  latencyHistogram queue; // send called to the NDI send starting on an executor thread
+  latencyHistogram send; // the NDI send itself, including any clocking
+  latencyHistogram total; // send called to promise resolution
+};
+
+// Shared with sends in flight, so counted like a frame pool
+struct senderLatency {
+  sendLatency video;
+  sendLatency audio;
+  std::atomic<uint32_t> refCount{1};
+};
+
+senderLatency* retainSenderLatency(senderLatency* l);
+void releaseSenderLatency(senderLatency* l);
+
+struct sendDataCarrier;
+
+// Carriers of finished sends, reused by the next ones rather than freed.
+// Shared with sends in flight, and only touched on the JavaScript thread, like
+// a frame pool.
+struct sendCarrierPool {
+  std::vector<sendDataCarrier*> spares;
+  std::atomic<uint32_t> refCount{1};
+};
+
+void releaseSendCarrierPool(sendCarrierPool* p);
+
+// Bytes in a frame of the given format, or zero if it is not known
+size_t videoFrameSize(NDIlib_FourCC_video_type_e fourCC, int32_t xres, int32_t yres, int32_t lineStride);
+
+// Native state behind a sender's "embedded" external, counted so that relays
+// sending through it keep it alive after the external is collected
+struct senderState {
+  NDIlib_send_instance_t send = nullptr;
+  framePool* pool = new framePool;
+  senderLatency* latency = new senderLatency;
+  sendCarrierPool* carriers = new sendCarrierPool;
+  // Buffer of the last video frame sent asynchronously, which NDI reads from
+  // until the next asynchronous send or a flush
+  napi_ref pinnedVideo = nullptr;
+  // Running relays sending through this sender, at most one, which must stop
+  // before video is sent any other way or the sender is destroyed
+  uint32_t relays = 0;
+  std::atomic<int32_t> refCount{1};
+};
+
+napi_status getSender(napi_env env, napi_value sender, senderState** result);
+senderState* retainSender(senderState* s);
+// Only on the JavaScript thread, as the last reference destroys the NDI sender
+void releaseSender(napi_env env, senderState* s);
+
+// A carrier for a send through the sender, reset from its spares where there
+// is one. Tidying the carrier gives it back.
+sendDataCarrier* acquireSendCarrier(senderState* sender);
+void recycleSendCarrier(sendDataCarrier* c);
+
 struct sendCarrier : carrier {
   char* name = nullptr;
   char* groups = nullptr;
@@ -38,10 +120,28 @@ struct sendDataCarrier : carrier {
   NDIlib_audio_frame_v3_t audioFrame;
   NDIlib_metadata_frame_t metadataFrame;
   napi_ref sourceBufferRef = nullptr;
+  framePool* pool = nullptr;
+  senderLatency* latency = nullptr;
+  sendCarrierPool* carriers = nullptr;
+  HR_TIME_POINT queued;
+  HR_TIME_POINT sendStart;
   ~sendDataCarrier() {
-    // TODO: free sourceBufferRef
+    if (pool != nullptr) {
+      releaseFramePool(pool);
+    }
+    if (latency != nullptr) {
+      releaseSenderLatency(latency);
+    }
+    if (carriers != nullptr) {
+      releaseSendCarrierPool(carriers);
+    }
   }
+  // Left set by sends rejected before they could be queued
+  void releaseRefs(napi_env env) override;
+  void recycle() override { recycleSendCarrier(this); }
 };
 
+/*  parse a video frame object, leaving the buffer that holds its data  */
+void videoFrameFromJs(napi_env env, napi_value config, sendDataCarrier* c, napi_value* buffer);
 
 #endif /* GRANDIOSE_SEND_H */
@@ -0,0 +1,309 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <Processing.NDI.Lib.h>
+
+#include "grandiose_util.h"
+#include "grandiose_receive.h"
+#include "grandiose_stream.h"
+#include "grandiose_trace.h"
+#include "grandiose_metrics.h"
+#include "util.h"
+
+receiverStream::receiverStream(receiverState *receiver, const receiverStreamOptions &options)
+    : receiver(retainReceiver(receiver)), options(options), ring(options.ringSize, nullptr)
+{
+}
+
+receiverStream::~receiverStream()
+{
+  running = false;
+  if (thread.joinable())
+    thread.join();
+
+  for (size_t i = 0; i < count; i++)
+    delete ring[(head + i) % ring.size()];
+  for (dataCarrier *c : spare)
+    delete c;
+
+  releaseReceiver(receiver);
+}
+
+bool receiverStream::start(const Napi::Env &env, const Napi::Function &callback)
+{
+  tsfn = Napi::ThreadSafeFunction::New(
+      env, callback, "ReceiverStream", 0, 1, this,
+      [](Napi::Env, receiverStream *stream)
+      { delete stream; });
+  if (env.IsExceptionPending())
+    return false;
+
+  running = true;
+  thread = std::thread(&receiverStream::run, this);
+  return true;
+}
+
+void receiverStream::stop()
+{
+  running = false;
+  if (thread.joinable())
+    thread.join();
+
+  // Frames still queued for delivery are dropped along with the stream
+  tsfn.Release();
+}
+
+// Take a carrier to capture into. Carriers are recycled once delivered, so
+// only a few more than the ring size are ever allocated.
+dataCarrier *receiverStream::acquire()
+{
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!spare.empty())
+    {
+      dataCarrier *c = spare.back();
+      spare.pop_back();
+      return c;
+    }
+  }
+
+  dataCarrier *c = new dataCarrier;
+  c->receiver = retainReceiver(receiver);
+  c->recv = receiver->recv;
+  c->audioFormat = options.audioFormat;
+  c->referenceLevel = options.referenceLevel;
+  return c;
+}
+
+void receiverStream::recycle(dataCarrier *c)
+{
+  releaseFrames(c);
+  c->status = GRANDIOSE_SUCCESS;
+
+  std::lock_guard<std::mutex> guard(lock);
+  spare.push_back(c);
+}
+
+void receiverStream::run()
+{
+  traceThreadName("grandiose stream");
+  while (running)
+  {
+    traceScope span(TRACE_RECEIVE, "streamCapture");
+    dataCarrier *c = acquire();
+    c->frameType = captureFrame(receiver,
+                                options.video ? &c->videoFrame : nullptr,
+                                options.audio ? &c->audioFrame : nullptr,
+                                options.metadata ? &c->metadataFrame : nullptr,
+                                options.wait < STREAM_WAIT ? options.wait : STREAM_WAIT);
+    switch (c->frameType)
+    {
+    case NDIlib_frame_type_none:
+      recycle(c);
+      continue;
+    case NDIlib_frame_type_audio:
+      convertAudio(c);
+      if (c->status != GRANDIOSE_SUCCESS)
+      {
+        recycle(c);
+        continue;
+      }
+      break;
+    case NDIlib_frame_type_error:
+      // Report the lost connection once per wait period rather than spinning
+      for (uint32_t slept = 0; running && slept < options.wait; slept += STREAM_WAIT)
+        std::this_thread::sleep_for(std::chrono::milliseconds(
+            options.wait - slept < STREAM_WAIT ? options.wait - slept : STREAM_WAIT));
+      break;
+    default:
+      break;
+    }
+
+    traceFlowStart(TRACE_RECEIVE, "stream", c);
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (count == ring.size())
+      {
+        dataCarrier *oldest = ring[head];
+        head = (head + 1) % ring.size();
+        count--;
+        receiver->counters.streamDropped.fetch_add(1, std::memory_order_relaxed);
+        metrics.streamDropped.fetch_add(1, std::memory_order_relaxed);
+        releaseFrames(oldest);
+        spare.push_back(oldest);
+      }
+      ring[(head + count) % ring.size()] = c;
+      count++;
+    }
+
+    // Only one delivery needs to be queued at a time, as it drains the ring
+    if (!scheduled.exchange(true))
+      tsfn.NonBlockingCall(this, deliver);
+  }
+}
+
+void receiverStream::deliver(Napi::Env env, Napi::Function callback, receiverStream *stream)
+{
+  traceScope span(TRACE_RECEIVE, "streamDeliver");
+  stream->scheduled = false;
+
+  std::vector<dataCarrier *> &frames = stream->delivering;
+  frames.clear();
+  {
+    std::lock_guard<std::mutex> guard(stream->lock);
+    for (; stream->count > 0; stream->count--)
+    {
+      frames.push_back(stream->ring[stream->head]);
+      stream->head = (stream->head + 1) % stream->ring.size();
+    }
+  }
+
+  for (dataCarrier *c : frames)
+  {
+    traceFlowEnd(TRACE_RECEIVE, "stream", c);
+    if (!stream->running || env.IsExceptionPending())
+    {
+      stream->recycle(c);
+      continue;
+    }
+
+    napi_value frame = nullptr;
+    napi_status status = napi_ok;
+    switch (c->frameType)
+    {
+    case NDIlib_frame_type_video:
+      status = videoFrameToJs(env, c, &frame);
+      break;
+    case NDIlib_frame_type_audio:
+      status = audioFrameToJs(env, c, &frame);
+      break;
+    case NDIlib_frame_type_metadata:
+      status = metadataFrameToJs(env, c, &frame);
+      break;
+    case NDIlib_frame_type_status_change:
+    {
+      Napi::Object change = Napi::Object::New(env);
+      change.Set("type", "statusChange");
+      frame = change;
+      break;
+    }
+    case NDIlib_frame_type_error:
+    {
+      Napi::Error error = Napi::Error::New(env, "Received error response from NDI data request. Connection lost.");
+      error.Value().Set("code", std::to_string(GRANDIOSE_CONNECTION_LOST));
+      callback.Call({error.Value()});
+      break;
+    }
+    default:
+      break;
+    }
+
+    if (status != napi_ok)
+      checkStatus(env, status, __FILE__, __LINE__);
+    else if (frame != nullptr)
+      callback.Call({env.Null(), Napi::Value(env, frame)});
+
+    stream->recycle(c);
+  }
+}
+
+Napi::Value streamReceive(const Napi::CallbackInfo &info, receiverState *receiver)
+{
+  Napi::Env env = info.Env();
+
+  size_t callbackIndex = info.Length() > 1 ? 1 : 0;
+  if (info.Length() == 0 || !info[callbackIndex].IsFunction())
+  {
+    Napi::TypeError::New(env, "Expected a callback function").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  receiverStreamOptions options;
+  if (callbackIndex == 1 && !info[0].IsUndefined() && !info[0].IsNull())
+  {
+    if (!info[0].IsObject())
+    {
+      Napi::TypeError::New(env, "Expected an options object").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Object rawOptions = info[0].As<Napi::Object>();
+
+    if (!parseOptionalBoolean(env, rawOptions.Get("video"), options.video) ||
+        !parseOptionalBoolean(env, rawOptions.Get("audio"), options.audio) ||
+        !parseOptionalBoolean(env, rawOptions.Get("metadata"), options.metadata))
+    {
+      Napi::TypeError::New(env, "options.video, options.audio and options.metadata must be booleans").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    if (!parseOptionalUint32(env, rawOptions.Get("wait"), options.wait))
+    {
+      Napi::TypeError::New(env, "options.wait must be a number").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    if (!parseOptionalUint32(env, rawOptions.Get("ringSize"), options.ringSize) ||
+        options.ringSize == 0 || options.ringSize > STREAM_MAX_RING_SIZE)
+    {
+      Napi::TypeError::New(env, "options.ringSize must be a number from 1 to " + std::to_string(STREAM_MAX_RING_SIZE))
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    uint32_t audioFormat = options.audioFormat;
+    if (!parseOptionalUint32(env, rawOptions.Get("audioFormat"), audioFormat) ||
+        !validAudioFormat((Grandiose_audio_format_e)audioFormat))
+    {
+      Napi::TypeError::New(env, "Invalid audio format specified.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    options.audioFormat = (Grandiose_audio_format_e)audioFormat;
+
+    uint32_t referenceLevel = options.referenceLevel;
+    if (!parseOptionalUint32(env, rawOptions.Get("referenceLevel"), referenceLevel))
+    {
+      Napi::TypeError::New(env, "options.referenceLevel must be a number").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    options.referenceLevel = (int32_t)referenceLevel;
+  }
+
+  if (receiver->stream != nullptr)
+  {
+    Napi::Error::New(env, "Receiver is already streaming").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  receiverStream *stream = new receiverStream(receiver, options);
+  if (!stream->start(env, info[callbackIndex].As<Napi::Function>()))
+  {
+    delete stream;
+    return env.Undefined();
+  }
+  receiver->stream = stream;
+
+  return env.Undefined();
+}
+
+void stopStreamReceive(receiverState *receiver)
+{
+  if (receiver->stream != nullptr)
+  {
+    receiver->stream->stop();
+    receiver->stream = nullptr;
+  }
+}
@@ -0,0 +1,80 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_STREAM_H
+#define GRANDIOSE_STREAM_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "napi.h"
+#include "grandiose_util.h"
+#include "grandiose_receive.h"
+
+// The longest a capture thread waits before checking whether its stream has
+// been stopped, so the longest stopStream() blocks for
+#define STREAM_WAIT 100
+// Frames a stream's ring can hold, which is allocated up front
+#define STREAM_MAX_RING_SIZE 1024
+
+struct receiverStreamOptions {
+  bool video = true;
+  bool audio = true;
+  bool metadata = true;
+  uint32_t wait = 100;
+  uint32_t ringSize = 4;
+  Grandiose_audio_format_e audioFormat = Grandiose_audio_format_float_32_separate;
+  int32_t referenceLevel = 20;
+};
+
+// Captures frames from a receiver on a dedicated thread into a bounded ring,
+// pushing them to a JavaScript callback through a thread-safe function. When
+// the ring is full the oldest frame is dropped. The stream is deleted by the
+// finalizer of its thread-safe function once it has been stopped.
+class receiverStream
+{
+public:
+  receiverStream(receiverState *receiver, const receiverStreamOptions &options);
+  ~receiverStream();
+
+  bool start(const Napi::Env &env, const Napi::Function &callback);
+  void stop();
+
+private:
+  void run();
+  dataCarrier *acquire();
+  void recycle(dataCarrier *c);
+  static void deliver(Napi::Env env, Napi::Function callback, receiverStream *stream);
+
+  receiverState *receiver;
+  receiverStreamOptions options;
+  Napi::ThreadSafeFunction tsfn;
+  std::thread thread;
+  std::atomic<bool> running{false};
+  std::atomic<bool> scheduled{false};
+
+  std::mutex lock;
+  std::vector<dataCarrier *> ring;
+  size_t head = 0;
+  size_t count = 0;
+  std::vector<dataCarrier *> spare;
+  std::vector<dataCarrier *> delivering; // only used by deliver()
+};
+
+Napi::Value streamReceive(const Napi::CallbackInfo &info, receiverState *receiver);
+void stopStreamReceive(receiverState *receiver);
+
+#endif /* GRANDIOSE_STREAM_H */
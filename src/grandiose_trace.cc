@@ -0,0 +1,278 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <uv.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "grandiose_trace.h"
+#include "grandiose_util.h"
+
+std::atomic<bool> tracingEnabled{false};
+
+struct traceEvent {
+  const char* category;
+  const char* name;
+  uint64_t timestamp; // nanoseconds, from uv_hrtime like Node's trace events
+  const void* id; // flows only
+  char phase; // B, E, s or f
+};
+
+// A ring written only by its own thread. The count of events written is
+// published after each event, so the reader can copy up to it and then
+// discard any that the writer may have lapped while it was copying.
+struct traceBuffer {
+  traceEvent* events;
+  uint32_t capacity;
+  std::atomic<uint64_t> written{0};
+  std::atomic<const char*> threadName{nullptr};
+  std::atomic<bool> retired{false}; // thread has exited
+  uint64_t threadId;
+  uint64_t read = 0; // only touched by the reader, under traceLock
+  uint64_t dropped = 0;
+
+  traceBuffer(uint32_t capacity, uint64_t threadId)
+    : events(new traceEvent[capacity]), capacity(capacity), threadId(threadId) {}
+  ~traceBuffer() { delete[] events; }
+};
+
+static std::mutex traceLock;
+static std::vector<traceBuffer*> traceBuffers;
+static std::atomic<uint32_t> traceCapacity{TRACE_DEFAULT_EVENTS};
+
+static uint64_t currentThreadId() {
+#ifdef _WIN32
+  return (uint64_t) GetCurrentThreadId();
+#elif defined(__APPLE__)
+  uint64_t id = 0;
+  pthread_threadid_np(nullptr, &id);
+  return id;
+#else
+  return (uint64_t) syscall(SYS_gettid);
+#endif
+}
+
+// Registers the thread's buffer the first time it records, and retires it
+// when the thread exits so the reader can free it once drained
+struct traceThread {
+  traceBuffer* buffer = nullptr;
+  const char* name = nullptr;
+  ~traceThread() {
+    if (buffer != nullptr) buffer->retired = true;
+    buffer = nullptr;
+  }
+};
+
+static thread_local traceThread localTrace;
+
+static traceBuffer* localBuffer() {
+  if (localTrace.buffer == nullptr) {
+    traceBuffer* buffer = new traceBuffer(traceCapacity.load(), currentThreadId());
+    buffer->threadName = localTrace.name;
+    std::lock_guard<std::mutex> guard(traceLock);
+    traceBuffers.push_back(buffer);
+    localTrace.buffer = buffer;
+  }
+  return localTrace.buffer;
+}
+
+static void traceRecord(char phase, const char* category, const char* name, const void* id) {
+  traceBuffer* b = localBuffer();
+  uint64_t n = b->written.load(std::memory_order_relaxed);
+  traceEvent& e = b->events[n % b->capacity];
+  e.category = category;
+  e.name = name;
+  e.timestamp = uv_hrtime();
+  e.id = id;
+  e.phase = phase;
+  b->written.store(n + 1, std::memory_order_release);
+}
+
+void traceBegin(const char* category, const char* name) {
+  if (tracing()) traceRecord('B', category, name, nullptr);
+}
+
+void traceEnd(const char* category, const char* name) {
+  if (tracing()) traceRecord('E', category, name, nullptr);
+}
+
+void traceFlowStart(const char* category, const char* name, const void* id) {
+  if (tracing()) traceRecord('s', category, name, id);
+}
+
+void traceFlowEnd(const char* category, const char* name, const void* id) {
+  if (tracing()) traceRecord('f', category, name, id);
+}
+
+void traceThreadName(const char* name) {
+  // Threads that never record do not need a buffer
+  localTrace.name = name;
+  if (localTrace.buffer != nullptr) localTrace.buffer->threadName = name;
+}
+
+static void appendEvent(std::string& json, const traceEvent& e, int pid, uint64_t tid) {
+  char line[320];
+  int length = snprintf(line, sizeof(line),
+    "%s{\"ph\":\"%c\",\"cat\":\"%s\",\"name\":\"%s\",\"pid\":%d,\"tid\":%" PRIu64
+    ",\"ts\":%" PRIu64 ".%03u",
+    json.back() == '[' ? "\n" : ",\n", e.phase, e.category, e.name, pid, tid,
+    e.timestamp / 1000, (unsigned) (e.timestamp % 1000));
+  if (length <= 0) return;
+  json.append(line, length < (int) sizeof(line) ? length : sizeof(line) - 1);
+  if (e.id != nullptr) {
+    length = snprintf(line, sizeof(line), ",\"id\":\"%p\"%s", e.id,
+      e.phase == 'f' ? ",\"bp\":\"e\"" : "");
+    if (length > 0) json.append(line, length);
+  }
+  json.append("}");
+}
+
+// Copy out the events written since the last dump
+static void drainBuffer(traceBuffer* b, std::vector<traceEvent>& events) {
+  uint64_t written = b->written.load(std::memory_order_acquire);
+  // The oldest slot is the next to be written, so may be mid-write
+  uint64_t first = written >= b->capacity ? written - b->capacity + 1 : 0;
+  if (first < b->read) first = b->read;
+  b->dropped += first - b->read;
+
+  size_t start = events.size();
+  for (uint64_t i = first; i < written; i++) {
+    events.push_back(b->events[i % b->capacity]);
+  }
+
+  // The writer may have lapped the oldest events while they were copied
+  uint64_t after = b->written.load(std::memory_order_acquire);
+  uint64_t safe = after >= b->capacity ? after - b->capacity + 1 : 0;
+  if (safe > first) {
+    uint64_t torn = (safe < written ? safe : written) - first;
+    events.erase(events.begin() + start, events.begin() + start + torn);
+    b->dropped += torn;
+  }
+  b->read = written;
+}
+
+napi_value traceStart(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  size_t argc = 1;
+  napi_value args[1];
+  status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+  CHECK_STATUS;
+
+  if (argc >= 1) {
+    napi_valuetype type;
+    status = napi_typeof(env, args[0], &type);
+    CHECK_STATUS;
+    if (type == napi_object) {
+      napi_value param;
+      status = napi_get_named_property(env, args[0], "bufferSize", &param);
+      CHECK_STATUS;
+      status = napi_typeof(env, param, &type);
+      CHECK_STATUS;
+      if (type == napi_number) {
+        uint32_t bufferSize;
+        status = napi_get_value_uint32(env, param, &bufferSize);
+        CHECK_STATUS;
+        if (bufferSize < 64) NAPI_THROW_ERROR("Trace buffer size must be at least 64 events.");
+        // Only threads that have not yet recorded take up the new size
+        traceCapacity = bufferSize;
+      }
+    }
+  }
+
+  tracingEnabled = true;
+
+  napi_value result;
+  status = napi_get_undefined(env, &result);
+  CHECK_STATUS;
+  return result;
+}
+
+napi_value traceStop(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  tracingEnabled = false;
+
+  napi_value result;
+  status = napi_get_undefined(env, &result);
+  CHECK_STATUS;
+  return result;
+}
+
+// Returns the events recorded since the last dump as a Chrome trace JSON
+// string. Events lost to full buffers are counted in otherData.
+napi_value traceDump(napi_env env, napi_callback_info info) {
+  napi_status status;
+
+  int pid = (int) uv_os_getpid();
+  uint64_t dropped = 0;
+  std::string json = "{\"traceEvents\":[";
+  std::vector<traceEvent> events;
+  {
+    std::lock_guard<std::mutex> guard(traceLock);
+    for (auto it = traceBuffers.begin(); it != traceBuffers.end(); ) {
+      traceBuffer* b = *it;
+      // Read retired before draining, so no events can follow
+      bool retired = b->retired.load();
+
+      const char* threadName = b->threadName.load();
+      if (threadName != nullptr) {
+        char line[200];
+        int length = snprintf(line, sizeof(line),
+          "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%" PRIu64
+          ",\"args\":{\"name\":\"%s\"}}", json.back() == '[' ? "\n" : ",\n",
+          pid, b->threadId, threadName);
+        if (length > 0 && length < (int) sizeof(line)) json.append(line, length);
+      }
+
+      events.clear();
+      drainBuffer(b, events);
+      for (const traceEvent& e : events) {
+        appendEvent(json, e, pid, b->threadId);
+      }
+      dropped += b->dropped;
+      b->dropped = 0;
+
+      if (retired) {
+        delete b;
+        it = traceBuffers.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  char footer[100];
+  snprintf(footer, sizeof(footer),
+    "\n],\"otherData\":{\"droppedEvents\":%" PRIu64 "}}", dropped);
+  json.append(footer);
+
+  napi_value result;
+  status = napi_create_string_utf8(env, json.c_str(), json.length(), &result);
+  CHECK_STATUS;
+  return result;
+}
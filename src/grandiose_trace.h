@@ -0,0 +1,75 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GRANDIOSE_TRACE_H
+#define GRANDIOSE_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include "node_api.h"
+
+// Begin and end events from the native hot paths, for loading into Perfetto
+// or chrome://tracing alongside the output of node --trace-events-enabled.
+// Each thread writes into its own ring of events without locking, which is
+// drained as Chrome trace JSON by trace.dump(). Names and categories must be
+// string literals, as only the pointers are kept. Timestamps come from the
+// same clock as Node's own trace events.
+
+#define TRACE_DEFAULT_EVENTS 16384 // per thread, about 640KB
+
+#define TRACE_RECEIVE "grandiose.receive"
+#define TRACE_SEND "grandiose.send"
+#define TRACE_FIND "grandiose.find"
+
+extern std::atomic<bool> tracingEnabled;
+
+inline bool tracing() {
+  return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+void traceBegin(const char* category, const char* name);
+void traceEnd(const char* category, const char* name);
+// Link work started on one thread to where it continues on another, such as
+// a capture on an executor thread and its completion on the JavaScript
+// thread. Must be called inside a begin / end pair on each thread.
+void traceFlowStart(const char* category, const char* name, const void* id);
+void traceFlowEnd(const char* category, const char* name, const void* id);
+// Label the calling thread in the trace
+void traceThreadName(const char* name);
+
+// Begins an event now and ends it when going out of scope
+class traceScope {
+public:
+  traceScope(const char* category, const char* name)
+    : category(category), name(name), active(tracing()) {
+    if (active) traceBegin(category, name);
+  }
+  ~traceScope() {
+    if (active) traceEnd(category, name);
+  }
+  traceScope(const traceScope&) = delete;
+  traceScope& operator=(const traceScope&) = delete;
+
+private:
+  const char* category;
+  const char* name;
+  bool active;
+};
+
+napi_value traceStart(napi_env env, napi_callback_info info);
+napi_value traceStop(napi_env env, napi_callback_info info);
+napi_value traceDump(napi_env env, napi_callback_info info);
+
+#endif /* GRANDIOSE_TRACE_H */
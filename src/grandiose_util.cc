@@ -16,6 +16,9 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 #include <chrono>
 #include <string>
 #include <cstddef>
@@ -78,11 +81,11 @@ napi_status checkStatus(napi_env env, napi_status status,
 
   infoStatus = napi_get_last_error_info(env, &errorInfo);
   assert(infoStatus == napi_ok);
-  printf("NAPI error in file %s on line %i. Error %i: %s\n", file, line,
+  LOG_ERROR("NAPI error in file %s on line %i. Error %i: %s", file, line,
     errorInfo->error_code, errorInfo->error_message);
 
   if (status == napi_pending_exception) {
-    printf("NAPI pending exception. Engine error code: %i\n", errorInfo->engine_error_code);
+    LOG_ERROR("NAPI pending exception. Engine error code: %i", errorInfo->engine_error_code);
     return status;
   }
 
@@ -153,12 +156,10 @@ void tidyCarrier(napi_env env, carrier* c) {
   if (c->passthru != nullptr) {
     status = napi_delete_reference(env, c->passthru);
     FLOATING_STATUS;
+    c->passthru = nullptr;
   }
-  if (c->_request != nullptr) {
-    status = napi_delete_async_work(env, c->_request);
-    FLOATING_STATUS;
-  }
-  delete c;
+  c->releaseRefs(env);
+  c->recycle();
 }
 
 int32_t rejectStatus(napi_env env, carrier* c, const char* file, int32_t line) {
@@ -241,6 +242,25 @@ bool validAudioFormat(Grandiose_audio_format_e format) {
   }
 }
 
+void *alignedAlloc(size_t size, size_t alignment) {
+#ifdef _WIN32
+  return _aligned_malloc(size, alignment);
+#else
+  void *result = nullptr;
+  if (posix_memalign(&result, alignment, size) != 0)
+    return nullptr;
+  return result;
+#endif
+}
+
+void alignedFree(void *ptr) {
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
 // // Make a native source object from components of a source object
 // napi_status makeNativeSource(napi_env env, napi_value source, NDIlib_source_t *result) {
 //   const char* name = nullptr;
@@ -279,3 +299,33 @@ bool validAudioFormat(Grandiose_audio_format_e format) {
 //   result->p_url_address = url;
 //   return napi_ok;
 // }
+
+Napi::Maybe<Napi::Object> newInternal(const Napi::FunctionReference &constructor, void *state,
+                                      const std::vector<napi_value> &rest)
+{
+  Napi::Env env = constructor.Env();
+  GrandioseInstanceData *instance = env.GetInstanceData<GrandioseInstanceData>();
+
+  std::vector<napi_value> args{Napi::External<void>::New(env, state)};
+  args.insert(args.end(), rest.begin(), rest.end());
+
+  // Constructors can run JavaScript, which could make other objects
+  void *previous = instance->constructing;
+  instance->constructing = state;
+  Napi::Maybe<Napi::Object> result = constructor.New(args);
+  instance->constructing = previous;
+  return result;
+}
+
+void *internalState(const Napi::CallbackInfo &info)
+{
+  GrandioseInstanceData *instance = info.Env().GetInstanceData<GrandioseInstanceData>();
+  if (instance->constructing == nullptr || info.Length() < 1 || !info[0].IsExternal())
+    return nullptr;
+  void *state = info[0].As<Napi::External<void>>().Data();
+  if (state != instance->constructing)
+    return nullptr;
+  // Taken once, before the constructor runs anything else
+  instance->constructing = nullptr;
+  return state;
+}
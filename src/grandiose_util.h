@@ -19,11 +19,16 @@
 #include <chrono>
 #include <stdio.h>
 #include <string>
+#include <memory>
+#include <vector>
 #include <cstddef>
 #include <Processing.NDI.Lib.h>
 #include "node_api.h"
 
 #include "napi.h"
+#include "grandiose_executor.h"
+#include "grandiose_log.h"
+#include "grandiose_ndi.h"
 
 
 // The three different formats of raw audio data supported by NDI utility functions
@@ -68,6 +73,7 @@ napi_status checkArgs(napi_env env, napi_callback_info info, char* methodName,
 #define GRANDIOSE_SEND_CREATE_FAIL 4102
 #define GRANDIOSE_ROUTING_CREATE_FAIL 4103
 #define GRANDIOSE_FIND_CREATE_FAIL 4104
+#define GRANDIOSE_NDI_LOAD_FAIL 4105
 #define GRANDIOSE_NOT_FOUND 4040
 #define GRANDIOSE_NOT_VIDEO 4140
 #define GRANDIOSE_NOT_AUDIO 4141
@@ -77,12 +83,18 @@ napi_status checkArgs(napi_env env, napi_callback_info info, char* methodName,
 
 struct carrier {
   virtual ~carrier() {}
+  // Called by tidyCarrier once the carrier is finished with. Carriers of
+  // per-frame work override this to reset and keep themselves for reuse.
+  virtual void recycle() { delete this; }
+  // Called by tidyCarrier first, to delete references that need the
+  // environment beyond passthru
+  virtual void releaseRefs(napi_env env) {}
   napi_ref passthru = nullptr;
   int32_t status = GRANDIOSE_SUCCESS;
   std::string errorMsg;
   long long totalTime;
   napi_deferred _deferred;
-  napi_async_work _request = nullptr;
+  executorWork _work;
 };
 
 void tidyCarrier(napi_env env, carrier* c);
@@ -91,7 +103,7 @@ int32_t rejectStatus(napi_env env, carrier* c, const char* file, int32_t line);
 #define REJECT_STATUS if (rejectStatus(env, c, __FILE__, __LINE__) != GRANDIOSE_SUCCESS) return;
 #define REJECT_RETURN if (rejectStatus(env, c, __FILE__, __LINE__) != GRANDIOSE_SUCCESS) return promise;
 #define FLOATING_STATUS if (status != napi_ok) { \
-  printf("Unexpected N-API status not OK in file %s at line %d value %i.\n", \
+  LOG_WARN("Unexpected N-API status not OK in file %s at line %d value %i.", \
     __FILE__, __LINE__ - 1, status); \
 }
 
@@ -114,11 +126,41 @@ int32_t rejectStatus(napi_env env, carrier* c, const char* file, int32_t line);
   REJECT_RETURN; \
 }
 
+// Per-environment state of the add-on, shared by all of its instances on a thread
+struct GrandioseInstanceData
+{
+  std::unique_ptr<Napi::FunctionReference> finder;
+  executorDispatcher *executor = nullptr;
+  std::unique_ptr<Napi::FunctionReference> frameSync;
+  std::unique_ptr<Napi::FunctionReference> receiver;
+  std::unique_ptr<Napi::FunctionReference> relay;
+  std::unique_ptr<Napi::FunctionReference> routing;
+  // Frame classes registered by index.js for binary headers
+  Napi::FunctionReference videoFrame;
+  Napi::FunctionReference audioFrame;
+  // Native state being passed to a constructor by newInternal()
+  void *constructing = nullptr;
+};
+
+// Classes that only grandiose makes can still be constructed from JavaScript,
+// through the constructor property of their objects. Their native state is
+// passed in an External, so they are made with newInternal() and take their
+// state with internalState(), which refuses Externals from anywhere else,
+// such as a sender's embedded one.
+Napi::Maybe<Napi::Object> newInternal(const Napi::FunctionReference &constructor, void *state,
+                                      const std::vector<napi_value> &rest = {});
+// The state passed by newInternal() as the first argument, or null
+void *internalState(const Napi::CallbackInfo &info);
+
 bool validColorFormat(NDIlib_recv_color_format_e format);
 bool validBandwidth(NDIlib_recv_bandwidth_e bandwidth);
 bool validFrameFormat(NDIlib_frame_format_type_e format);
 bool validAudioFormat(Grandiose_audio_format_e format);
 
+// Memory aligned for SIMD access, released with alignedFree
+void *alignedAlloc(size_t size, size_t alignment);
+void alignedFree(void *ptr);
+
 napi_status makeNativeSource(napi_env env, napi_value source, NDIlib_source_t *result);
 
 #endif // GRANDIOSE_UTIL_H
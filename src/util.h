@@ -4,7 +4,7 @@
 
 // TODO: It would be really nice to use std::optional here, but it is not widely enough supported yet to make that viable
 
-bool parseBoolean(const Napi::Env &env, const Napi::Maybe<Napi::Value> &value, bool &output)
+inline bool parseBoolean(const Napi::Env &env, const Napi::Maybe<Napi::Value> &value, bool &output)
 {
     Napi::Value rawValue = value.UnwrapOr(env.Null());
     if (rawValue.IsUndefined() || rawValue.IsNull())
@@ -20,7 +20,35 @@ bool parseBoolean(const Napi::Env &env, const Napi::Maybe<Napi::Value> &value, b
     return true;
 }
 
-bool parseString(const Napi::Env &env, const Napi::Maybe<Napi::Value> &value, std::string &output)
+// As parseBoolean, but leaves output untouched when the value is missing
+inline bool parseOptionalBoolean(const Napi::Env &env, const Napi::Maybe<Napi::Value> &value, bool &output)
+{
+    Napi::Value rawValue = value.UnwrapOr(env.Null());
+    if (rawValue.IsUndefined() || rawValue.IsNull())
+        return true;
+
+    if (!rawValue.IsBoolean())
+        return false;
+
+    output = rawValue.As<Napi::Boolean>().Value();
+    return true;
+}
+
+// Leaves output untouched when the value is missing
+inline bool parseOptionalUint32(const Napi::Env &env, const Napi::Maybe<Napi::Value> &value, uint32_t &output)
+{
+    Napi::Value rawValue = value.UnwrapOr(env.Null());
+    if (rawValue.IsUndefined() || rawValue.IsNull())
+        return true;
+
+    if (!rawValue.IsNumber())
+        return false;
+
+    output = rawValue.As<Napi::Number>().Uint32Value();
+    return true;
+}
+
+inline bool parseString(const Napi::Env &env, const Napi::Maybe<Napi::Value> &value, std::string &output)
 {
     Napi::Value rawValue = value.UnwrapOr(env.Null());
     if (rawValue.IsUndefined() || rawValue.IsNull())
@@ -66,7 +94,7 @@ bool parseString(const Napi::Env &env, const Napi::Maybe<Napi::Value> &value, st
 //     return result;
 // }
 
-Napi::Object convertSourceToNapi(const Napi::Env &env, const NDIlib_source_t &source)
+inline Napi::Object convertSourceToNapi(const Napi::Env &env, const NDIlib_source_t &source)
 {
     Napi::Object object = Napi::Object::New(env);
 
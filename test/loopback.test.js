@@ -0,0 +1,98 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+const { test } = require('node:test')
+const assert = require('node:assert/strict')
+const { grandiose, senderSource, videoFrame, audioFrame } = require('./mock.js')
+
+test('video sent is received', async () => {
+  const sender = await grandiose.send({ name: 'loopback-video', clockVideo: false })
+  const receiver = await grandiose.receive({ source: senderSource('loopback-video') })
+  try {
+    await sender.video(videoFrame(0x42))
+    const frame = await receiver.video(1000)
+    assert.equal(frame.type, 'video')
+    assert.equal(frame.xres, 16)
+    assert.equal(frame.yres, 8)
+    assert.equal(frame.fourCC, grandiose.FOURCC_UYVY)
+    assert.equal(frame.data.length, 16 * 2 * 8)
+    assert.ok(frame.data.every((byte) => byte === 0x42))
+  } finally {
+    await sender.destroy()
+  }
+})
+
+test('video sent from the frame pool is received', async () => {
+  const sender = await grandiose.send({ name: 'loopback-pool', clockVideo: false })
+  const receiver = await grandiose.receive({ source: senderSource('loopback-pool') })
+  try {
+    const frame = videoFrame(0)
+    for (let i = 1; i <= 3; i++) {
+      frame.data = sender.allocFrame({ xres: frame.xres, yres: frame.yres, fourCC: frame.fourCC })
+      frame.data.fill(i)
+      await sender.video(frame)
+      const received = await receiver.video(1000)
+      assert.equal(received.data[0], i)
+    }
+    assert.ok(sender.framePoolStats().recycled > 0)
+  } finally {
+    await sender.destroy()
+  }
+})
+
+test('audio sent is received', async () => {
+  const sender = await grandiose.send({ name: 'loopback-audio', clockAudio: false })
+  const receiver = await grandiose.receive({ source: senderSource('loopback-audio') })
+  try {
+    await sender.audio(audioFrame(0.25))
+    const frame = await receiver.audio({ audioFormat: grandiose.AUDIO_FORMAT_FLOAT_32_SEPARATE }, 1000)
+    assert.equal(frame.type, 'audio')
+    assert.equal(frame.channels, 2)
+    assert.equal(frame.samples, 480)
+    assert.equal(frame.data.readFloatLE(0), 0.25)
+    assert.equal(frame.data.readFloatLE(frame.channelStrideInBytes), 1.25)
+  } finally {
+    await sender.destroy()
+  }
+})
+
+test('sends with bad arguments are rejected', async () => {
+  const sender = await grandiose.send({ name: 'loopback-bad', clockAudio: false })
+  try {
+    await assert.rejects(sender.audio({ ...audioFrame(0), fourCC: 'FLTp' }), { code: '4001' })
+    await assert.rejects(sender.video({ ...videoFrame(0), data: 'not a buffer' }), { code: '4001' })
+    // Rejected sends leave their carriers fit to be reused
+    const receiver = await grandiose.receive({ source: senderSource('loopback-bad') })
+    await sender.audio(audioFrame(0.5))
+    const frame = await receiver.audio({ audioFormat: grandiose.AUDIO_FORMAT_FLOAT_32_SEPARATE }, 1000)
+    assert.equal(frame.data.readFloatLE(0), 0.5)
+  } finally {
+    await sender.destroy()
+  }
+})
+
+test('video shorter than its format is refused', async () => {
+  const sender = await grandiose.send({ name: 'loopback-short', clockVideo: false })
+  try {
+    const short = { ...videoFrame(0), data: Buffer.alloc(16 * 2 * 8 - 1) }
+    await assert.rejects(sender.video(short), { code: '4001' })
+    assert.throws(() => sender.videoAsync(short), { code: '4001' })
+    assert.throws(() => sender.videoAsync({ ...videoFrame(0), lineStrideBytes: 64 }), { code: '4001' })
+    sender.videoAsync(videoFrame(0))
+    sender.flushVideo()
+  } finally {
+    await sender.destroy()
+  }
+})
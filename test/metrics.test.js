@@ -0,0 +1,30 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+const { test } = require('node:test')
+const assert = require('node:assert/strict')
+const { grandiose, SYNTHETIC, metric } = require('./mock.js')
+
+test('metrics() counts frames received', async () => {
+  const text = grandiose.metrics()
+  assert.match(text, /^# TYPE grandiose_receivers gauge$/m)
+  assert.match(text, /^# TYPE grandiose_received_frames_total counter$/m)
+
+  const before = metric('grandiose_received_frames_total', 'type="video"')
+  const receiver = await grandiose.receive({ source: SYNTHETIC })
+  await receiver.video(1000)
+  assert.ok(metric('grandiose_received_frames_total', 'type="video"') > before)
+  assert.ok(metric('grandiose_receivers') >= 1)
+})
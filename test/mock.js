@@ -0,0 +1,96 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+// Loads grandiose against the mock NDI library, with small synthetic frames
+// so that the tests run quickly. Build both with npm run build:mock.
+
+const fs = require('fs')
+const path = require('path')
+const v8 = require('v8')
+const vm = require('vm')
+
+const mockLibrary = path.join(__dirname, '../build/Release/ndi_mock.so')
+if (!fs.existsSync(mockLibrary)) {
+  throw new Error(`${mockLibrary} not found, build it with npm run build:mock`)
+}
+
+process.env.GRANDIOSE_MOCK = '1'
+process.env.GRANDIOSE_MOCK_XRES = process.env.GRANDIOSE_MOCK_XRES || '64'
+process.env.GRANDIOSE_MOCK_YRES = process.env.GRANDIOSE_MOCK_YRES || '36'
+process.env.GRANDIOSE_MOCK_FRAME_RATE_N = process.env.GRANDIOSE_MOCK_FRAME_RATE_N || '100'
+process.env.GRANDIOSE_MOCK_FRAME_RATE_D = process.env.GRANDIOSE_MOCK_FRAME_RATE_D || '1'
+
+const grandiose = require('../index.js')
+
+const SYNTHETIC = { name: 'GRANDIOSE-MOCK (Synthetic 1)' }
+
+// The source that a sender or router of the given name is found as
+const senderSource = (name) => ({ name: `GRANDIOSE-MOCK (${name})` })
+
+// A UYVY frame with every byte set to value
+function videoFrame(value, xres = 16, yres = 8) {
+  return {
+    xres, yres,
+    frameRateN: 100, frameRateD: 1,
+    pictureAspectRatio: xres / yres,
+    frameFormatType: grandiose.FORMAT_TYPE_PROGRESSIVE,
+    fourCC: grandiose.FOURCC_UYVY,
+    lineStrideBytes: xres * 2,
+    timecode: 0,
+    data: Buffer.alloc(xres * 2 * yres, value),
+  }
+}
+
+// Planar float audio with every sample of channel c set to value + c
+function audioFrame(value, channels = 2, samples = 480) {
+  const data = Buffer.alloc(channels * samples * 4)
+  for (let c = 0; c < channels; c++) {
+    for (let s = 0; s < samples; s++) data.writeFloatLE(value + c, (c * samples + s) * 4)
+  }
+  return {
+    sampleRate: 48000,
+    noChannels: channels,
+    noSamples: samples,
+    channelStrideBytes: samples * 4,
+    fourCC: grandiose.FOURCC_FLTp,
+    timecode: 0,
+    data,
+  }
+}
+
+// The value of an unlabelled sample in grandiose.metrics(), or of the sample
+// with the given labels, such as 'type="video"'
+function metric(name, labels) {
+  const pattern = labels ? `${name}{${labels}}` : name
+  for (const line of grandiose.metrics().split('\n')) {
+    const space = line.lastIndexOf(' ')
+    if (line.slice(0, space) === pattern) return Number(line.slice(space + 1))
+  }
+  return undefined
+}
+
+v8.setFlagsFromString('--expose-gc')
+const gc = vm.runInNewContext('gc')
+
+// Collect garbage until the condition holds, or give up after a second
+async function collectUntil(condition) {
+  for (let i = 0; i < 100 && !condition(); i++) {
+    gc()
+    await new Promise((resolve) => setTimeout(resolve, 10))
+  }
+  return condition()
+}
+
+module.exports = { grandiose, SYNTHETIC, senderSource, videoFrame, audioFrame, metric, collectUntil }
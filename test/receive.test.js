@@ -0,0 +1,85 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+const { test } = require('node:test')
+const assert = require('node:assert/strict')
+const { grandiose, SYNTHETIC, senderSource, metric, collectUntil } = require('./mock.js')
+
+test('video is captured from a synthetic source', async () => {
+  const receiver = await grandiose.receive({ source: SYNTHETIC })
+  const frame = await receiver.video(1000)
+  assert.equal(frame.type, 'video')
+  assert.equal(frame.xres, 64)
+  assert.equal(frame.yres, 36)
+  assert.equal(frame.data.length, frame.lineStrideBytes * frame.yres)
+})
+
+test('video() rejects when no frame arrives in time', async () => {
+  const sender = await grandiose.send({ name: 'receive-video-timeout' })
+  try {
+    const receiver = await grandiose.receive({ source: senderSource('receive-video-timeout') })
+    await assert.rejects(receiver.video(20), { code: '4040' })
+  } finally {
+    await sender.destroy()
+  }
+})
+
+test('data() rejects when no frame arrives in time', async () => {
+  const sender = await grandiose.send({ name: 'receive-data-timeout' })
+  try {
+    const receiver = await grandiose.receive({ source: senderSource('receive-data-timeout') })
+    await assert.rejects(receiver.data(20), { code: '4040' })
+  } finally {
+    await sender.destroy()
+  }
+})
+
+test('receivers whose captures timed out are destroyed once collected', async () => {
+  const sender = await grandiose.send({ name: 'receive-collected' })
+  try {
+    const before = metric('grandiose_receivers')
+    await (async () => {
+      const receiver = await grandiose.receive({ source: senderSource('receive-collected') })
+      for (let i = 0; i < 3; i++) {
+        await assert.rejects(receiver.data(10))
+        await assert.rejects(receiver.video(10))
+        await assert.rejects(receiver.audio({}, 10))
+        await assert.rejects(receiver.metadata(10))
+      }
+      assert.equal(metric('grandiose_receivers'), before + 1)
+    })()
+    assert.ok(await collectUntil(() => metric('grandiose_receivers') === before),
+      'receiver was not destroyed')
+  } finally {
+    await sender.destroy()
+  }
+})
+
+test('constructors refuse externals they were not made for', async () => {
+  const sender = await grandiose.send({ name: 'receive-constructors' })
+  try {
+    const receiver = await grandiose.receive({ source: SYNTHETIC })
+    assert.throws(() => new receiver.constructor(sender.embedded), TypeError)
+    assert.throws(() => new receiver.constructor(), TypeError)
+    const frameSync = receiver.frameSync()
+    assert.throws(() => new frameSync.constructor(sender.embedded), TypeError)
+    frameSync.destroy()
+    const relay = receiver.relay(sender)
+    assert.throws(() => new relay.constructor(sender.embedded, sender), TypeError)
+    relay.stop()
+  } finally {
+    await sender.destroy()
+  }
+})
@@ -0,0 +1,111 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+const { test } = require('node:test')
+const assert = require('node:assert/strict')
+const { grandiose, SYNTHETIC, senderSource, videoFrame, metric, collectUntil } = require('./mock.js')
+
+test('a relay forwards video from its receiver to its sender', async () => {
+  const sender = await grandiose.send({ name: 'relay-forward' })
+  try {
+    const receiver = await grandiose.receive({ source: SYNTHETIC })
+    const relay = receiver.relay(sender, { audio: false, metadata: false })
+    try {
+      const output = await grandiose.receive({ source: senderSource('relay-forward') })
+      const frame = await output.video(1000)
+      assert.equal(frame.xres, 64)
+      assert.ok(relay.stats().video > 0)
+    } finally {
+      relay.stop()
+    }
+    assert.equal(relay.running, false)
+  } finally {
+    await sender.destroy()
+  }
+})
+
+test('a relay keeps sending after its sender\'s external is collected', async () => {
+  const sender = await grandiose.send({ name: 'relay-collected' })
+  const receiver = await grandiose.receive({ source: SYNTHETIC })
+  const relay = receiver.relay(sender, { audio: false, metadata: false })
+  try {
+    let collected = false
+    const registry = new FinalizationRegistry(() => { collected = true })
+    registry.register(sender.embedded, 'embedded')
+    sender.embedded = 0
+    assert.ok(await collectUntil(() => collected), 'external was not collected')
+
+    const output = await grandiose.receive({ source: senderSource('relay-collected') })
+    await output.video(1000)
+    assert.equal(relay.running, true)
+  } finally {
+    relay.stop()
+  }
+})
+
+test('a relay refuses a sender that has been destroyed', async () => {
+  const sender = await grandiose.send({ name: 'relay-destroyed' })
+  const embedded = sender.embedded
+  await sender.destroy()
+  const receiver = await grandiose.receive({ source: SYNTHETIC })
+  assert.throws(() => receiver.relay(sender), TypeError)
+  assert.throws(() => receiver.relay({ embedded }), TypeError)
+})
+
+test('a running relay is the only thing sending video on its sender', async () => {
+  const sender = await grandiose.send({ name: 'relay-exclusive', clockVideo: false })
+  try {
+    const receiver = await grandiose.receive({ source: SYNTHETIC })
+    const relay = receiver.relay(sender)
+    try {
+      await assert.rejects(sender.video(videoFrame(0)), { code: '4001' })
+      assert.throws(() => sender.videoAsync(videoFrame(0)), { code: '4001' })
+      assert.throws(() => sender.flushVideo(), { code: '4001' })
+      const second = await grandiose.receive({ source: SYNTHETIC })
+      assert.throws(() => second.relay(sender))
+      await assert.rejects(sender.destroy(), { code: '4001' })
+    } finally {
+      relay.stop()
+    }
+
+    sender.videoAsync(videoFrame(0))
+    sender.flushVideo()
+    const second = await grandiose.receive({ source: SYNTHETIC })
+    const other = second.relay(sender)
+    try {
+      assert.throws(() => relay.start())
+    } finally {
+      other.stop()
+    }
+  } finally {
+    await sender.destroy()
+  }
+})
+
+test('grandiose.relay() destroys its sender with the relay', async () => {
+  const relay = await grandiose.relay(SYNTHETIC, 'relay-owned', { audio: false, metadata: false })
+  const output = await grandiose.receive({ source: senderSource('relay-owned') })
+  await output.video(1000)
+  const senders = metric('grandiose_senders')
+  await relay.destroy()
+  assert.equal(relay.running, false)
+  assert.equal(metric('grandiose_senders'), senders - 1)
+})
+
+test('grandiose.relay() destroys its sender when the relay cannot be made', async () => {
+  const senders = metric('grandiose_senders')
+  await assert.rejects(grandiose.relay(SYNTHETIC, 'relay-refused', { video: 'yes' }), TypeError)
+  assert.equal(metric('grandiose_senders'), senders)
+})
@@ -0,0 +1,52 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+const { test } = require('node:test')
+const assert = require('node:assert/strict')
+const { grandiose, SYNTHETIC, senderSource } = require('./mock.js')
+
+test('a salvo switches every router', async () => {
+  const routers = await Promise.all([
+    grandiose.routing({ name: 'salvo-1' }),
+    grandiose.routing({ name: 'salvo-2' })
+  ])
+  try {
+    const results = await grandiose.routing.salvo([
+      { router: routers[0], source: SYNTHETIC },
+      { router: routers[1] }
+    ])
+    assert.deepEqual(results, [true, true])
+
+    const receiver = await grandiose.receive({ source: senderSource('salvo-1') })
+    const frame = await receiver.video(1000)
+    assert.equal(frame.xres, 64)
+  } finally {
+    await Promise.all(routers.map((router) => router.destroy()))
+  }
+})
+
+test('a salvo rejects entries that are not routers', async () => {
+  await assert.rejects(async () => grandiose.routing.salvo([{ router: {}, source: SYNTHETIC }]))
+
+  const router = await grandiose.routing({ name: 'salvo-forged' })
+  try {
+    const forged = Object.create(Object.getPrototypeOf(router))
+    await assert.rejects(async () => grandiose.routing.salvo([{ router: forged, source: SYNTHETIC }]),
+      { code: '4001' })
+  } finally {
+    await router.destroy()
+  }
+  await assert.rejects(async () => grandiose.routing.salvo('salvo'))
+})
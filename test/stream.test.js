@@ -0,0 +1,59 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+const { test } = require('node:test')
+const assert = require('node:assert/strict')
+const { grandiose, SYNTHETIC, senderSource } = require('./mock.js')
+
+test('a stream delivers video from a synthetic source', async () => {
+  const receiver = await grandiose.receive({ source: SYNTHETIC })
+  try {
+    const frame = await new Promise((resolve, reject) => {
+      receiver.stream({ audio: false, metadata: false }, (err, frame) => {
+        if (err) reject(err)
+        else if (frame.type === 'video') resolve(frame)
+      })
+    })
+    assert.equal(frame.xres, 64)
+    assert.equal(frame.yres, 36)
+  } finally {
+    receiver.stopStream()
+  }
+})
+
+test('stopStream() returns promptly however long the wait', async () => {
+  const sender = await grandiose.send({ name: 'stream-stop' })
+  try {
+    const receiver = await grandiose.receive({ source: senderSource('stream-stop') })
+    receiver.stream({ wait: 10000 }, () => {})
+    await new Promise((resolve) => setTimeout(resolve, 50))
+    const start = process.hrtime.bigint()
+    receiver.stopStream()
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6
+    assert.ok(elapsed < 500, `stopStream() took ${elapsed}ms`)
+  } finally {
+    await sender.destroy()
+  }
+})
+
+test('stream options are validated', async () => {
+  const receiver = await grandiose.receive({ source: SYNTHETIC })
+  assert.throws(() => receiver.stream({ ringSize: 4e9 }, () => {}), TypeError)
+  assert.throws(() => receiver.stream({ ringSize: 1025 }, () => {}), TypeError)
+  assert.throws(() => receiver.stream({ ringSize: 0 }, () => {}), TypeError)
+  assert.throws(() => receiver.stream({}), TypeError)
+  receiver.stream({ ringSize: 1024 }, () => {})
+  receiver.stopStream()
+})
@@ -0,0 +1,52 @@
+/* Copyright 2018 Streampunk Media Ltd.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+const { test } = require('node:test')
+const assert = require('node:assert/strict')
+const { grandiose, SYNTHETIC, senderSource } = require('./mock.js')
+
+test('trace.dump() returns trace events', async () => {
+  grandiose.trace.start()
+  try {
+    const receiver = await grandiose.receive({ source: SYNTHETIC })
+    await receiver.video(1000)
+  } finally {
+    grandiose.trace.stop()
+  }
+  const trace = JSON.parse(grandiose.trace.dump())
+  assert.ok(Array.isArray(trace.traceEvents))
+  assert.ok(trace.traceEvents.length > 0)
+})
+
+test('relay captures and sends are traced on a named thread', async () => {
+  grandiose.trace.start()
+  try {
+    const relay = await grandiose.relay(SYNTHETIC, 'trace-relay', { audio: false, metadata: false })
+    try {
+      const output = await grandiose.receive({ source: senderSource('trace-relay') })
+      await output.video(1000)
+    } finally {
+      await relay.destroy()
+    }
+  } finally {
+    grandiose.trace.stop()
+  }
+  const events = JSON.parse(grandiose.trace.dump()).traceEvents
+  const thread = events.find((e) => e.name === 'thread_name' && e.args.name === 'grandiose relay')
+  assert.ok(thread, 'relay thread is not named')
+  for (const name of ['relayCapture', 'relaySendVideo', 'relayFlush']) {
+    assert.ok(events.some((e) => e.name === name && e.tid === thread.tid), `no ${name} event`)
+  }
+})